@@ -6,6 +6,9 @@ in vec3 normal;
 layout(location=0) out vec4 color;
 
 uniform sampler2D snow_height;
+uniform sampler2D snow_mask;
+uniform float snow_time;
+uniform float accumulation_rate;
 uniform sampler2D snow_texture;
 uniform sampler2D under_texture;
 
@@ -25,7 +28,9 @@ void main() {
 
     vec4 illumination = vec4(mix(ambient, sun, sun_illumination), 1);
     
-    float height = texture(snow_height, uv).r;
+    float height = min(texture(snow_mask, uv).r,
+                       snow_time * accumulation_rate
+                           + texture(snow_height, uv).r);
     float tex_mix_fact = clamp(height * 5.0, 0.0, 1.0);
     
     vec4 snow_color = texture(snow_texture, uv);
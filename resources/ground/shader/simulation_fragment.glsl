@@ -0,0 +1,28 @@
+#version 450
+
+// snow height of the previous step, same size as the target
+uniform sampler2D previous;
+uniform sampler2D snow_mask;
+// growth of this step
+uniform float amount;
+// share of the difference with the neighbours averaged in this step, the
+// diffusion rate times the step duration, 0 to 1
+uniform float diffusion;
+
+layout(location=0) out vec4 height;
+
+float previous_at(ivec2 texel, ivec2 last) {
+    return texelFetch(previous, clamp(texel, ivec2(0), last), 0).r;
+}
+
+void main() {
+    ivec2 texel = ivec2(gl_FragCoord.xy);
+    ivec2 last = textureSize(previous, 0) - 1;
+    float center = texelFetch(previous, texel, 0).r;
+    float neighbours = previous_at(texel + ivec2(1, 0), last)
+        + previous_at(texel - ivec2(1, 0), last)
+        + previous_at(texel + ivec2(0, 1), last)
+        + previous_at(texel - ivec2(0, 1), last);
+    float value = center + diffusion * (0.25 * neighbours - center);
+    height = vec4(min(texelFetch(snow_mask, texel, 0).r, value + amount), 0.0, 0.0, 1.0);
+}
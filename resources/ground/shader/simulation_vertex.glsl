@@ -0,0 +1,7 @@
+#version 450
+
+// one triangle covering the snow height target, corners from gl_VertexID
+void main() {
+    vec2 position = vec2(float((gl_VertexID & 1) << 2), float((gl_VertexID & 2) << 1)) - 1.0;
+    gl_Position = vec4(position, 0.0, 1.0);
+}
@@ -12,6 +12,10 @@ uniform vec3 up;
 uniform float scale;
 
 uniform sampler2D snow_height;
+uniform sampler2D snow_mask;
+// uniform growth since the start, 0 unless the ground is analytic
+uniform float snow_time;
+uniform float accumulation_rate;
 
 out vec2 uv;
 out vec3 normal;
@@ -20,7 +24,9 @@ void main() {
     uv = vUV;
     normal = vNormal;
     vec4 global_pos = model_transform * vec4(vPosition,1.0);
-    float height = texture(snow_height, uv).r;
+    float height = min(texture(snow_mask, uv).r,
+                       snow_time * accumulation_rate
+                           + texture(snow_height, uv).r);
     global_pos.xyz /= global_pos.w;
     global_pos.xyz += scale * up * height;
     gl_Position = projection * view_transform * global_pos;
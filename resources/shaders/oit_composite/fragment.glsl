@@ -0,0 +1,20 @@
+#version 450
+
+uniform sampler2D accumulation;
+uniform sampler2D revealage;
+
+layout(location=0) out vec4 output_color;
+
+void main() {
+    ivec2 texel = ivec2(gl_FragCoord.xy);
+    float revealed = texelFetch(revealage, texel, 0).r;
+    if (revealed >= 1.0)
+        discard; // no transparent fragment on this pixel
+
+    vec4 sum = texelFetch(accumulation, texel, 0);
+    // keeps the average finite when many bright fragments overflow
+    if (isinf(max(max(abs(sum.r), abs(sum.g)), abs(sum.b))))
+        sum.rgb = vec3(sum.a);
+    vec3 average = sum.rgb / max(sum.a, 1e-5);
+    output_color = vec4(average, 1.0 - revealed);
+}
@@ -0,0 +1,84 @@
+#version 450
+
+// must match GpuParticleSystem::WORK_GROUP_SIZE, each invocation compares
+// one pair so a group covers a block of twice as many elements
+layout(local_size_x = 64) in;
+const uint BLOCK_SIZE = 128u;
+
+// must match GpuParticleSystem::SortPass
+const int SORT_BLOCKS = 0;
+const int MERGE_GLOBAL = 1;
+const int MERGE_BLOCKS = 2;
+
+layout(std430, binding = 1) buffer Order {
+    uvec2 order[];
+};
+
+uniform int sort_pass;
+// width of the bitonic sequences being merged
+uniform int merge_size;
+// gap between compared elements, the first one for MERGE_BLOCKS
+uniform int merge_gap;
+
+shared uvec2 block[BLOCK_SIZE];
+
+// ties are broken by index so the result matches a stable sort
+bool greater(uvec2 a, uvec2 b) {
+    return a.x > b.x || (a.x == b.x && a.y > b.y);
+}
+
+// first element of pair p when comparing elements gap apart
+uint pair_low(uint p, uint gap) {
+    return ((p & ~(gap - 1u)) << 1) | (p & (gap - 1u));
+}
+
+void compare_block(uint p, uint width, uint gap) {
+    uint low = pair_low(p, gap);
+    uint high = low + gap;
+    bool ascending = ((gl_WorkGroupID.x * BLOCK_SIZE + low) & width) == 0u;
+    if (greater(block[low], block[high]) == ascending) {
+        uvec2 swap = block[low];
+        block[low] = block[high];
+        block[high] = swap;
+    }
+}
+
+void main() {
+    uint p = gl_LocalInvocationID.x;
+
+    if (sort_pass == MERGE_GLOBAL) {
+        uint low = pair_low(gl_GlobalInvocationID.x, uint(merge_gap));
+        uint high = low + uint(merge_gap);
+        bool ascending = (low & uint(merge_size)) == 0u;
+        uvec2 a = order[low];
+        uvec2 b = order[high];
+        if (greater(a, b) == ascending) {
+            order[low] = b;
+            order[high] = a;
+        }
+        return;
+    }
+
+    // the steps shorter than a block run in shared memory, in one dispatch
+    uint base = gl_WorkGroupID.x * BLOCK_SIZE;
+    block[p] = order[base + p];
+    block[p + BLOCK_SIZE / 2u] = order[base + p + BLOCK_SIZE / 2u];
+    barrier();
+
+    if (sort_pass == SORT_BLOCKS) {
+        for (uint width = 2u; width <= BLOCK_SIZE; width <<= 1) {
+            for (uint gap = width >> 1; gap > 0u; gap >>= 1) {
+                compare_block(p, width, gap);
+                barrier();
+            }
+        }
+    } else {
+        for (uint gap = uint(merge_gap); gap > 0u; gap >>= 1) {
+            compare_block(p, uint(merge_size), gap);
+            barrier();
+        }
+    }
+
+    order[base + p] = block[p];
+    order[base + p + BLOCK_SIZE / 2u] = block[p + BLOCK_SIZE / 2u];
+}
@@ -0,0 +1,55 @@
+#version 450
+
+// must match GpuParticleSystem::WORK_GROUP_SIZE
+layout(local_size_x = 64) in;
+
+struct Particle {
+    vec4 position;   // xyz, rotation in degrees
+    vec4 velocity;   // xyz, angular velocity in degrees per second
+    vec4 appearance; // scale, texture id, unused, unused
+};
+
+layout(std430, binding = 0) readonly buffer Particles {
+    Particle particles[];
+};
+
+// (key, particle index), padded to a power of two for the bitonic sort
+layout(std430, binding = 1) writeonly buffer Order {
+    uvec2 order[];
+};
+
+uniform int particle_count;
+uniform int padded_count;
+uniform vec3 sort_origin;
+
+// same mapping as float_sort_key: unsigned order of the keys is the order
+// of the floats
+uint float_sort_key(float value) {
+    uint bits = floatBitsToUint(value);
+    uint mask = (bits >> 31) != 0u ? 0xffffffffu : 0x80000000u;
+    return bits ^ mask;
+}
+
+// same as far_to_near_key: increasing keys go from the farthest particle
+// to the nearest
+uint far_to_near_key(float squared_distance) {
+    return ~float_sort_key(squared_distance);
+}
+
+void main() {
+    uint index = gl_GlobalInvocationID.x;
+    if (index >= uint(padded_count))
+        return;
+    if (index >= uint(particle_count)) {
+        // padding sorts after every particle and is never drawn, squared
+        // distances are positive so their keys never reach it
+        order[index] = uvec2(0xffffffffu, index);
+        return;
+    }
+    vec3 offset = particles[index].position.xyz - sort_origin;
+    // unfused and in the order of ParticleRenderer::sort_particles, so that
+    // both sorts compute the same keys
+    precise float squared_distance =
+        offset.x * offset.x + offset.y * offset.y + offset.z * offset.z;
+    order[index] = uvec2(far_to_near_key(squared_distance), index);
+}
@@ -0,0 +1,27 @@
+#version 450
+
+uniform sampler2DArray uTexture;
+uniform float layer_count;
+
+// weighted blended order-independent transparency targets
+layout(location=0) out vec4 accumulation;
+layout(location=1) out float revealage;
+
+in vec2 uv;
+flat in float texId;
+
+void main() {
+    float layer = clamp(floor(texId + 0.5),0,layer_count - 1);
+    vec4 tex_color = texture(uTexture, vec3(uv, layer));
+    if(tex_color.a < 0.1)
+        discard;
+
+    // closer and more opaque fragments weigh more in the average,
+    // McGuire and Bavoil's depth weight on the window depth
+    float alpha = tex_color.a;
+    float depth = 1.0 - gl_FragCoord.z * 0.9;
+    float weight = clamp(pow(min(1.0, alpha * 10.0) + 0.01, 3.0) * 1e8 * depth * depth * depth, 1e-2, 3e3);
+
+    accumulation = vec4(tex_color.rgb * alpha, alpha) * weight;
+    revealage = alpha;
+}
@@ -0,0 +1,75 @@
+#version 450
+
+// must match GpuParticleSystem::WORK_GROUP_SIZE
+layout(local_size_x = 64) in;
+
+struct Particle {
+    vec4 position;   // xyz, rotation in degrees
+    vec4 velocity;   // xyz, angular velocity in degrees per second
+    vec4 appearance; // scale, texture id, unused, unused
+};
+
+layout(std430, binding = 0) buffer Particles {
+    Particle particles[];
+};
+
+uniform int particle_count;
+uniform int seed;
+uniform int frame;
+uniform int spawn_all;
+uniform float delta;
+uniform float respawn_height;
+uniform float initial_height;
+uniform vec3 spawn_center;
+uniform float texture_count;
+uniform float max_angular_velocity;
+
+// integer hash (PCG output permutation), only uses 32-bit integer
+// arithmetic so every implementation gives the same sequence
+uint hash(uint value) {
+    uint state = value * 747796405u + 2891336453u;
+    uint word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+    return (word >> 22u) ^ word;
+}
+
+uint rng_state;
+
+float rand_range(float low, float high) {
+    rng_state = hash(rng_state);
+    return low + float(rng_state >> 8) * (1.0 / 16777216.0) * (high - low);
+}
+
+void spawn(uint index) {
+    rng_state = hash(index ^ hash(uint(frame) ^ hash(uint(seed))));
+
+    Particle particle = particles[index];
+    float x = spawn_center.x + rand_range(-3.0, 3.0);
+    float y = spawn_center.y + rand_range(-3.0, 3.0);
+    // the first spawn fills the whole column, respawns happen at the top
+    float z = spawn_all != 0 ? rand_range(respawn_height, initial_height) : spawn_center.z;
+    vec3 velocity = vec3(rand_range(-0.5, 0.5), rand_range(-0.5, 0.5), rand_range(-2.0, -1.0));
+    float tex_id = rand_range(0.0, texture_count);
+    float angle = rand_range(0.0, 360.0);
+    float angular_velocity = rand_range(-max_angular_velocity, max_angular_velocity);
+    float scale = spawn_all != 0 ? 1.0 : particle.appearance.x;
+
+    particle.position = vec4(x, y, z, angle);
+    particle.velocity = vec4(velocity, angular_velocity);
+    particle.appearance = vec4(scale, tex_id, 0.0, 0.0);
+    particles[index] = particle;
+}
+
+void main() {
+    uint index = gl_GlobalInvocationID.x;
+    if (index >= uint(particle_count))
+        return;
+
+    if (spawn_all != 0 || particles[index].position.z < respawn_height) {
+        spawn(index);
+        return;
+    }
+
+    Particle particle = particles[index];
+    particle.position += particle.velocity * delta;
+    particles[index].position = particle.position;
+}
@@ -1,18 +1,43 @@
 #version 450
 
-in vec3 vPosition;
-in vec2 vUV;
-in float vTexId;
+// one instance per flake, the quad corners come from gl_VertexID
+in vec3 vCenter;  // half floats, relative to instance_origin
+in uvec2 vPacked; // rotation and layer, see ParticleInstance
 
 uniform mat4 projection;
+uniform vec3 instance_origin;
 uniform mat4 model_transform;
 uniform mat4 view_transform;
+// shared by every flake, see ParticleInstance
+uniform float particle_scale;
+
+const float BILLBOARD_SIZE = 0.225;
+const float TAU = 6.28318530718;
+const vec3 UP = vec3(0.0, 0.0, 1.0);
 
 out vec2 uv;
 out flat float texId;
 
 void main() {
-    gl_Position = projection * view_transform * model_transform * vec4(vPosition, 1.0);
-    uv = vUV;
-    texId = vTexId;
-}
\ No newline at end of file
+    // triangle strip order: (0,1), (0,0), (1,1), (1,0)
+    uv = vec2(float(gl_VertexID >> 1), float(1 - (gl_VertexID & 1)));
+    vec2 corner = uv - 0.5;
+
+    float angle = float(vPacked.x) / 256.0 * TAU;
+    texId = float(vPacked.y);
+
+    // quad faces the camera: its normal is the third row of the view
+    // rotation, i.e. the camera backward axis
+    vec3 y_axis = vec3(view_transform[0][2], view_transform[1][2], view_transform[2][2]);
+    vec3 x_axis = normalize(cross(UP, y_axis));
+    vec3 z_axis = normalize(cross(y_axis, x_axis));
+
+    // rotation of the flake around the quad normal
+    float c = cos(angle);
+    float s = sin(angle);
+    vec2 rotated = vec2(c * corner.x + s * corner.y, -s * corner.x + c * corner.y);
+    rotated *= BILLBOARD_SIZE * particle_scale;
+
+    vec3 position = instance_origin + vCenter + rotated.x * x_axis + rotated.y * z_axis;
+    gl_Position = projection * view_transform * model_transform * vec4(position, 1.0);
+}
@@ -0,0 +1,55 @@
+#version 450
+
+// same billboards as vertex.glsl, read from the simulation buffer
+struct Particle {
+    vec4 position;   // xyz, rotation in degrees
+    vec4 velocity;   // xyz, angular velocity in degrees per second
+    vec4 appearance; // scale, texture id, unused, unused
+};
+
+layout(std430, binding = 0) readonly buffer Particles {
+    Particle particles[];
+};
+
+// (key, particle index) in drawing order, written by bitonic_sort.glsl
+layout(std430, binding = 1) readonly buffer Order {
+    uvec2 order[];
+};
+
+// draw through the order buffer instead of in simulation order
+uniform int sorted;
+
+uniform mat4 projection;
+uniform mat4 model_transform;
+uniform mat4 view_transform;
+
+const float BILLBOARD_SIZE = 0.225;
+const vec3 UP = vec3(0.0, 0.0, 1.0);
+
+out vec2 uv;
+out flat float texId;
+
+void main() {
+    uint index = sorted != 0 ? order[gl_InstanceID].y : uint(gl_InstanceID);
+    Particle particle = particles[index];
+
+    // triangle strip order: (0,1), (0,0), (1,1), (1,0)
+    uv = vec2(float(gl_VertexID >> 1), float(1 - (gl_VertexID & 1)));
+    vec2 corner = uv - 0.5;
+
+    float angle = radians(particle.position.w);
+    float scale = particle.appearance.x;
+    texId = particle.appearance.y;
+
+    vec3 y_axis = vec3(view_transform[0][2], view_transform[1][2], view_transform[2][2]);
+    vec3 x_axis = normalize(cross(UP, y_axis));
+    vec3 z_axis = normalize(cross(y_axis, x_axis));
+
+    float c = cos(angle);
+    float s = sin(angle);
+    vec2 rotated = vec2(c * corner.x + s * corner.y, -s * corner.x + c * corner.y);
+    rotated *= BILLBOARD_SIZE * scale;
+
+    vec3 position = particle.position.xyz + rotated.x * x_axis + rotated.y * z_axis;
+    gl_Position = projection * view_transform * model_transform * vec4(position, 1.0);
+}
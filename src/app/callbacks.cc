@@ -21,6 +21,7 @@ namespace pogl
         CHECK_GL_ERROR();
         const auto aspect_ratio = width / (float)height;
         Engine::instance().update_perspective(aspect_ratio);
+        Engine::instance().update_framebuffer_size(width, height);
     }
 
     void on_key_update(GLFWwindow *window, int key, int, int action, int)
@@ -0,0 +1,169 @@
+#include "buffer.hh"
+
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include "utils/gl_check.hh"
+#include "utils/log.hh"
+
+namespace pogl
+{
+    Buffer::Buffer(GLenum target, GLenum usage, UpdatePolicy policy)
+        : _buffer_id(0)
+        , _target(target)
+        , _usage_hint(usage)
+        , _policy(policy)
+        , _size(0)
+        , _usage{ 0, 0, 0, 0 }
+    {
+        glGenBuffers(1, &_buffer_id);
+        CHECK_GL_ERROR();
+    }
+
+    Buffer::~Buffer()
+    {
+        release();
+    }
+
+    Buffer::Buffer(Buffer &&other)
+        : _buffer_id(std::exchange(other._buffer_id, 0))
+        , _target(other._target)
+        , _usage_hint(other._usage_hint)
+        , _policy(other._policy)
+        , _size(std::exchange(other._size, 0))
+        , _usage(other._usage)
+    {}
+
+    Buffer &Buffer::operator=(Buffer &&other)
+    {
+        if (this != &other)
+        {
+            release();
+            _buffer_id = std::exchange(other._buffer_id, 0);
+            _target = other._target;
+            _usage_hint = other._usage_hint;
+            _policy = other._policy;
+            _size = std::exchange(other._size, 0);
+            _usage = other._usage;
+        }
+        return *this;
+    }
+
+    void Buffer::release()
+    {
+        if (_buffer_id != 0)
+        {
+            glDeleteBuffers(1, &_buffer_id);
+            CHECK_GL_ERROR();
+            _buffer_id = 0;
+        }
+    }
+
+    void Buffer::allocate(const void *data, size_t size)
+    {
+        bind();
+        glBufferData(_target, size, data, _usage_hint);
+        CHECK_GL_ERROR();
+        _size = size;
+        _usage.allocations++;
+        if (data != nullptr)
+        {
+            _usage.bytes_uploaded += size;
+        }
+    }
+
+    void Buffer::write(const void *data, size_t offset, size_t size)
+    {
+        if (offset + size > _size)
+        {
+            std::cerr << LOG_ERROR << "buffer update of " << size
+                      << " bytes at offset " << offset
+                      << " overflows its storage of " << _size << " bytes"
+                      << std::endl;
+            throw std::out_of_range("Buffer update out of range");
+        }
+        if (size == 0)
+        {
+            return;
+        }
+
+        bind();
+        const bool whole = offset == 0 && size == _size;
+        if (_policy == UpdatePolicy::ORPHAN && whole)
+        {
+            // the old storage lives on until the GPU is done with it
+            glBufferData(_target, _size, nullptr, _usage_hint);
+            CHECK_GL_ERROR();
+            _usage.orphanings++;
+        }
+
+        if (_policy == UpdatePolicy::SUB_DATA
+            || (_policy == UpdatePolicy::ORPHAN && whole))
+        {
+            glBufferSubData(_target, offset, size, data);
+            CHECK_GL_ERROR();
+        }
+        else
+        {
+            auto *mapping = glMapBufferRange(
+                _target, offset, size,
+                GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+            CHECK_GL_ERROR();
+            if (mapping == nullptr)
+            {
+                std::cerr << LOG_ERROR << "could not map " << size
+                          << " bytes of buffer " << _buffer_id << std::endl;
+                throw std::logic_error("Buffer mapping failed");
+            }
+            std::memcpy(mapping, data, size);
+            const auto intact = glUnmapBuffer(_target);
+            CHECK_GL_ERROR();
+            if (intact == GL_FALSE)
+            {
+                // the store was lost while mapped (e.g. a mode switch), the
+                // range is undefined until written again
+                std::cerr << LOG_WARNING << "buffer " << _buffer_id
+                          << " was corrupted while mapped, rewriting "
+                          << size << " bytes" << std::endl;
+                glBufferSubData(_target, offset, size, data);
+                CHECK_GL_ERROR();
+            }
+        }
+
+        _usage.updates++;
+        _usage.bytes_uploaded += size;
+    }
+
+    void Buffer::bind() const
+    {
+        glBindBuffer(_target, _buffer_id);
+        CHECK_GL_ERROR();
+    }
+
+    void Buffer::unbind() const
+    {
+        glBindBuffer(_target, 0);
+        CHECK_GL_ERROR();
+    }
+
+    GLuint Buffer::id() const
+    {
+        return _buffer_id;
+    }
+
+    GLenum Buffer::target() const
+    {
+        return _target;
+    }
+
+    size_t Buffer::size() const
+    {
+        return _size;
+    }
+
+    const Buffer::Usage &Buffer::usage() const
+    {
+        return _usage;
+    }
+} // namespace pogl
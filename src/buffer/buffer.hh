@@ -0,0 +1,121 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <cstddef>
+#include <span>
+
+namespace pogl
+{
+    /**
+     * @brief Owning wrapper of an OpenGL buffer object.
+     *
+     * Data is passed as typed spans, sizes and offsets are in elements of
+     * the span type. Uploads leave the buffer bound, so that element buffers
+     * stay attached to the bound vertex array. Updates of a range go through
+     * the buffer's update policy, which decides how the driver avoids
+     * stalling on storage the GPU may still read.
+     */
+    class Buffer
+    {
+    public:
+        enum class UpdatePolicy
+        {
+            /**
+             * @brief glBufferSubData, the driver synchronises as it sees fit
+             */
+            SUB_DATA,
+            /**
+             * @brief Updates of the whole buffer first detach its storage
+             * and get a fresh one, partial updates map and invalidate the
+             * written range.
+             */
+            ORPHAN,
+            /**
+             * @brief Maps the written range with GL_MAP_INVALIDATE_RANGE_BIT
+             */
+            MAP_INVALIDATE,
+        };
+
+        /**
+         * @brief Counters of the traffic sent to the buffer
+         */
+        struct Usage
+        {
+            size_t allocations;
+            size_t updates;
+            size_t orphanings;
+            size_t bytes_uploaded;
+        };
+
+        /**
+         * @brief Creates an empty buffer.
+         *
+         * @param target binding point used when binding the buffer
+         * @param usage hint given to glBufferData
+         * @param policy
+         */
+        explicit Buffer(GLenum target, GLenum usage = GL_STATIC_DRAW,
+                        UpdatePolicy policy = UpdatePolicy::SUB_DATA);
+        ~Buffer();
+
+        Buffer(const Buffer &) = delete;
+        Buffer &operator=(const Buffer &) = delete;
+        Buffer(Buffer &&other);
+        Buffer &operator=(Buffer &&other);
+
+        /**
+         * @brief Reallocates the storage to the size of data and uploads it
+         *
+         * @param data
+         */
+        template <typename T>
+        void set_data(std::span<const T> data);
+
+        /**
+         * @brief Overwrites the elements starting at element first with data,
+         * which must fit in the current storage.
+         *
+         * @param data
+         * @param first
+         */
+        template <typename T>
+        void update(std::span<const T> data, size_t first = 0);
+
+        void bind() const;
+        void unbind() const;
+
+        GLuint id() const;
+        GLenum target() const;
+
+        /**
+         * @brief Size of the storage in bytes
+         *
+         * @return size_t
+         */
+        size_t size() const;
+
+        /**
+         * @brief Number of T the storage holds
+         *
+         * @return size_t
+         */
+        template <typename T>
+        size_t count() const;
+
+        const Usage &usage() const;
+
+    private:
+        void allocate(const void *data, size_t size);
+        void write(const void *data, size_t offset, size_t size);
+        void release();
+
+        GLuint _buffer_id;
+        GLenum _target;
+        GLenum _usage_hint;
+        UpdatePolicy _policy;
+        size_t _size;
+        Usage _usage;
+    };
+} // namespace pogl
+
+#include "buffer.hxx"
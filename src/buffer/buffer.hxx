@@ -0,0 +1,24 @@
+#pragma once
+
+#include "buffer.hh"
+
+namespace pogl
+{
+    template <typename T>
+    void Buffer::set_data(std::span<const T> data)
+    {
+        allocate(data.data(), data.size_bytes());
+    }
+
+    template <typename T>
+    void Buffer::update(std::span<const T> data, size_t first)
+    {
+        write(data.data(), first * sizeof(T), data.size_bytes());
+    }
+
+    template <typename T>
+    size_t Buffer::count() const
+    {
+        return _size / sizeof(T);
+    }
+} // namespace pogl
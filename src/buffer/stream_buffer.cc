@@ -0,0 +1,137 @@
+#include "stream_buffer.hh"
+
+#include <stdexcept>
+
+#include "utils/gl_check.hh"
+#include "utils/log.hh"
+
+namespace pogl
+{
+    namespace
+    {
+        constexpr GLbitfield MAPPING_FLAGS =
+            GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        // one second, only reached when the GPU is far behind
+        constexpr GLuint64 FENCE_TIMEOUT_NS = 1000000000;
+    } // namespace
+
+    StreamBuffer::StreamBuffer(GLenum target, size_t region_size)
+        : _buffer_id(0)
+        , _target(target)
+        , _region_size(region_size)
+        , _region_index(REGION_COUNT - 1)
+        , _mapping(nullptr)
+        , _fences()
+    {
+        // glBufferStorage rejects an empty store, and an empty mapping
+        // could never hold a region
+        if (_region_size == 0)
+        {
+            std::cerr << LOG_ERROR << "stream buffer regions cannot be empty"
+                      << std::endl;
+            throw std::logic_error("Empty stream buffer region");
+        }
+
+        const auto size = _region_size * REGION_COUNT;
+        glGenBuffers(1, &_buffer_id);
+        CHECK_GL_ERROR();
+        bind();
+        glBufferStorage(_target, size, nullptr, MAPPING_FLAGS);
+        CHECK_GL_ERROR();
+        _mapping = static_cast<std::byte *>(
+            glMapBufferRange(_target, 0, size, MAPPING_FLAGS));
+        CHECK_GL_ERROR();
+        glBindBuffer(_target, 0);
+        CHECK_GL_ERROR();
+
+        if (_mapping == nullptr)
+        {
+            std::cerr << LOG_ERROR << "could not map stream buffer of " << size
+                      << " bytes" << std::endl;
+            throw std::logic_error("Stream buffer mapping failed");
+        }
+        _fences.fill(nullptr);
+    }
+
+    StreamBuffer::~StreamBuffer()
+    {
+        for (auto fence : _fences)
+        {
+            if (fence != nullptr)
+            {
+                glDeleteSync(fence);
+                CHECK_GL_ERROR();
+            }
+        }
+        bind();
+        glUnmapBuffer(_target);
+        CHECK_GL_ERROR();
+        glBindBuffer(_target, 0);
+        CHECK_GL_ERROR();
+        glDeleteBuffers(1, &_buffer_id);
+        CHECK_GL_ERROR();
+    }
+
+    void *StreamBuffer::begin_region()
+    {
+        _region_index = (_region_index + 1) % REGION_COUNT;
+        wait_fence(_region_index);
+        return _mapping + region_offset();
+    }
+
+    void StreamBuffer::end_region()
+    {
+        _fences[_region_index] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        CHECK_GL_ERROR();
+    }
+
+    void StreamBuffer::bind() const
+    {
+        glBindBuffer(_target, _buffer_id);
+        CHECK_GL_ERROR();
+    }
+
+    GLuint StreamBuffer::id() const
+    {
+        return _buffer_id;
+    }
+
+    size_t StreamBuffer::region_size() const
+    {
+        return _region_size;
+    }
+
+    size_t StreamBuffer::region_index() const
+    {
+        return _region_index;
+    }
+
+    size_t StreamBuffer::region_offset() const
+    {
+        return _region_index * _region_size;
+    }
+
+    void StreamBuffer::wait_fence(size_t region)
+    {
+        auto &fence = _fences[region];
+        if (fence == nullptr)
+        {
+            return;
+        }
+
+        GLenum status;
+        do
+        {
+            status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT,
+                                      FENCE_TIMEOUT_NS);
+        } while (status == GL_TIMEOUT_EXPIRED);
+        if (status == GL_WAIT_FAILED)
+        {
+            CHECK_GL_ERROR();
+        }
+
+        glDeleteSync(fence);
+        CHECK_GL_ERROR();
+        fence = nullptr;
+    }
+} // namespace pogl
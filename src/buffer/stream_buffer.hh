@@ -0,0 +1,78 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <array>
+#include <cstddef>
+
+namespace pogl
+{
+    /**
+     * @brief Buffer written by the CPU every frame through a persistent
+     * coherent mapping.
+     *
+     * The storage is split in REGION_COUNT regions used in turn, a fence
+     * placed after the draw reading a region guarantees it is not written
+     * again while the GPU may still read it.
+     */
+    class StreamBuffer
+    {
+    public:
+        static constexpr size_t REGION_COUNT = 3;
+
+        /**
+         * @brief Allocates REGION_COUNT regions of region_size bytes and maps
+         * them for the whole lifetime of the buffer.
+         *
+         * @param target binding point used when binding the buffer
+         * @param region_size in bytes, a zero size throws std::logic_error
+         */
+        StreamBuffer(GLenum target, size_t region_size);
+        ~StreamBuffer();
+
+        StreamBuffer(const StreamBuffer &) = delete;
+        StreamBuffer &operator=(const StreamBuffer &) = delete;
+
+        /**
+         * @brief Moves to the next region, waiting for the GPU to be done
+         * with it if needed.
+         *
+         * @return void* start of the mapped region
+         */
+        void *begin_region();
+
+        /**
+         * @brief Fences the current region, to be called once the commands
+         * reading it have been issued.
+         */
+        void end_region();
+
+        void bind() const;
+
+        GLuint id() const;
+        size_t region_size() const;
+
+        /**
+         * @brief Index of the region returned by the last begin_region
+         *
+         * @return size_t
+         */
+        size_t region_index() const;
+
+        /**
+         * @brief Offset in bytes of the current region in the buffer
+         *
+         * @return size_t
+         */
+        size_t region_offset() const;
+
+    private:
+        void wait_fence(size_t region);
+
+        GLuint _buffer_id;
+        GLenum _target;
+        size_t _region_size;
+        size_t _region_index;
+        std::byte *_mapping;
+        std::array<GLsync, REGION_COUNT> _fences;
+    };
+} // namespace pogl
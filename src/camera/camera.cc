@@ -1,8 +1,10 @@
 #include "camera.hh"
 
+#include <algorithm>
 #include <cmath>
 
 #include "inputstate/inputstate.hh"
+#include "object/height_field.hh"
 
 namespace pogl
 {
@@ -16,6 +18,8 @@ namespace pogl
         , _pitch(pitch)
         , _yaw(yaw)
         , _projection(projection)
+        , _ground(nullptr)
+        , _eye_height(0)
     {}
 
     Vector3 Camera::get_forward() const
@@ -57,6 +61,12 @@ namespace pogl
         return _projection;
     }
 
+    Frustum Camera::get_frustum() const
+    {
+        // column vectors: world to clip space is projection * view
+        return Frustum::from_matrix(_projection * get_transform());
+    }
+
     Self &Camera::move_relative(const Vector3 &movement)
     {
         const auto forward = Vector3(std::cos(_yaw), std::sin(_yaw), 0);
@@ -119,6 +129,23 @@ namespace pogl
             Vector3(x_input, y_input, z_input).normalized();
         const auto movement = movement_direction * SPEED * delta;
         move_relative(movement);
+
+        if (_ground)
+        {
+            // -infinity off the ground, where nothing is clamped
+            const auto ground_height =
+                _ground->height(_position.x, _position.y);
+            _position.z = std::max<float>(_position.z,
+                                          ground_height + _eye_height);
+        }
+    }
+
+    Self &Camera::set_ground(std::shared_ptr<const HeightField> ground,
+                             float eye_height)
+    {
+        _ground = ground;
+        _eye_height = eye_height;
+        return *this;
     }
 
 } // namespace pogl
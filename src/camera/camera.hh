@@ -1,11 +1,16 @@
 #pragma once
 
+#include <memory>
+
+#include "frustum.hh"
 #include "matrix4/matrix4.hh"
 #include "properties/updateable.hh"
 #include "vector3/vector3.hh"
 
 namespace pogl
 {
+    class HeightField;
+
     class Camera : public Updateable
     {
     public:
@@ -22,10 +27,28 @@ namespace pogl
         Matrix4 get_transform() const;
         Matrix4 get_projection() const;
         Vector3 get_forward() const;
+
+        /**
+         * @brief View volume of the camera, in world space
+         *
+         * @return Frustum
+         */
+        Frustum get_frustum() const;
         Self &move_relative(const Vector3 &movement);
 
         void set_projection(const Matrix4 &projection);
 
+        /**
+         * @brief Keeps the camera at least eye_height above the ground when
+         * it moves over it. A null ground lets the camera move freely.
+         *
+         * @param ground
+         * @param eye_height
+         * @return Self&
+         */
+        Self &set_ground(std::shared_ptr<const HeightField> ground,
+                         float eye_height);
+
         const Vector3 &get_position() const;
 
         virtual void update(double delta) override;
@@ -35,6 +58,8 @@ namespace pogl
         double _pitch;
         double _yaw;
         Matrix4 _projection;
+        std::shared_ptr<const HeightField> _ground;
+        float _eye_height;
     };
 
 } // namespace pogl
@@ -0,0 +1,105 @@
+#include "frustum.hh"
+
+#include <cmath>
+
+#include "utils/cpu_features.hh"
+
+namespace pogl
+{
+    namespace
+    {
+        Plane make_plane(const Matrix4 &m, size_t row, float sign)
+        {
+            // last row plus or minus another row, see Gribb & Hartmann
+            Plane plane{
+                m.at(0, 3) + sign * m.at(0, row),
+                m.at(1, 3) + sign * m.at(1, row),
+                m.at(2, 3) + sign * m.at(2, row),
+                m.at(3, 3) + sign * m.at(3, row),
+            };
+            const auto norm = std::sqrt(plane.a * plane.a + plane.b * plane.b
+                                        + plane.c * plane.c);
+            plane.a /= norm;
+            plane.b /= norm;
+            plane.c /= norm;
+            plane.d /= norm;
+            return plane;
+        }
+    } // namespace
+
+    Frustum::Frustum(const PlanesType &planes)
+        : _planes(planes)
+    {}
+
+    Frustum Frustum::from_matrix(const Matrix4 &clip_transform)
+    {
+        return Frustum(PlanesType{
+            make_plane(clip_transform, 0, 1), // left
+            make_plane(clip_transform, 0, -1), // right
+            make_plane(clip_transform, 1, 1), // bottom
+            make_plane(clip_transform, 1, -1), // top
+            make_plane(clip_transform, 2, 1), // near
+            make_plane(clip_transform, 2, -1), // far
+        });
+    }
+
+    bool Frustum::intersects_sphere(const Vector3 &center, float radius) const
+    {
+        for (const auto &plane : _planes)
+        {
+            if (plane.distance(center) < -radius)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    size_t Frustum::cull_spheres(const float *x, const float *y,
+                                 const float *z, size_t count, float radius,
+                                 IndexType *visible_indices) const
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        if (cpu_features().avx2)
+        {
+            return kernels::cull_spheres_avx2(_planes, x, y, z, count, radius,
+                                              visible_indices);
+        }
+#endif
+        return kernels::cull_spheres_scalar(_planes, x, y, z, 0, count,
+                                            radius, visible_indices, 0);
+    }
+
+    const Frustum::PlanesType &Frustum::planes() const
+    {
+        return _planes;
+    }
+
+    namespace kernels
+    {
+        size_t cull_spheres_scalar(const Frustum::PlanesType &planes,
+                                   const float *x, const float *y,
+                                   const float *z, size_t begin, size_t count,
+                                   float radius,
+                                   Frustum::IndexType *visible_indices,
+                                   size_t visible_count)
+        {
+            for (size_t i = begin; i < count; ++i)
+            {
+                bool visible = true;
+                for (const auto &plane : planes)
+                {
+                    const auto distance =
+                        plane.a * x[i] + plane.b * y[i] + plane.c * z[i]
+                        + plane.d;
+                    visible = visible && distance >= -radius;
+                }
+                if (visible)
+                {
+                    visible_indices[visible_count++] = i;
+                }
+            }
+            return visible_count;
+        }
+    } // namespace kernels
+} // namespace pogl
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "matrix4/matrix4.hh"
+#include "vector3/vector3.hh"
+
+namespace pogl
+{
+    /**
+     * @brief Plane of equation `a * x + b * y + c * z + d = 0`, with a unit
+     * normal (a, b, c) pointing towards the inside of the frustum.
+     */
+    struct Plane
+    {
+        float a;
+        float b;
+        float c;
+        float d;
+
+        inline float distance(const Vector3 &point) const
+        {
+            return a * point.x + b * point.y + c * point.z + d;
+        }
+    };
+
+    /**
+     * @brief View volume of a camera as six planes, used to skip objects that
+     * cannot be seen.
+     */
+    class Frustum
+    {
+    public:
+        static constexpr size_t PLANE_COUNT = 6;
+        using IndexType = std::uint32_t;
+        using PlanesType = std::array<Plane, PLANE_COUNT>;
+
+        /**
+         * @brief Extracts the planes of the clip space volume of a
+         * `projection * view` matrix (Gribb & Hartmann), in the space the
+         * view matrix transforms from.
+         *
+         * @param clip_transform
+         * @return Frustum
+         */
+        static Frustum from_matrix(const Matrix4 &clip_transform);
+
+        /**
+         * @brief Whether a sphere is at least partly inside the frustum. May
+         * report spheres close to the frustum corners as visible.
+         *
+         * @param center
+         * @param radius
+         * @return true
+         * @return false
+         */
+        bool intersects_sphere(const Vector3 &center, float radius) const;
+
+        /**
+         * @brief Writes the indices of the spheres intersecting the frustum
+         * to visible_indices, in increasing order. The spheres are given as
+         * coordinate arrays and share the same radius.
+         *
+         * @param x
+         * @param y
+         * @param z
+         * @param count number of spheres
+         * @param radius
+         * @param visible_indices output, must hold at least count elements
+         * @return size_t number of visible spheres
+         */
+        size_t cull_spheres(const float *x, const float *y, const float *z,
+                            size_t count, float radius,
+                            IndexType *visible_indices) const;
+
+        const PlanesType &planes() const;
+
+    private:
+        explicit Frustum(const PlanesType &planes);
+
+        PlanesType _planes;
+    };
+
+    namespace kernels
+    {
+        size_t cull_spheres_scalar(const Frustum::PlanesType &planes,
+                                   const float *x, const float *y,
+                                   const float *z, size_t begin, size_t count,
+                                   float radius,
+                                   Frustum::IndexType *visible_indices,
+                                   size_t visible_count);
+        size_t cull_spheres_avx2(const Frustum::PlanesType &planes,
+                                 const float *x, const float *y,
+                                 const float *z, size_t count, float radius,
+                                 Frustum::IndexType *visible_indices);
+    } // namespace kernels
+} // namespace pogl
@@ -0,0 +1,51 @@
+#include "frustum.hh"
+
+#if defined(__x86_64__) || defined(__i386__)
+#    include <immintrin.h>
+
+namespace pogl::kernels
+{
+    // Eight spheres are tested against every plane at once, the lanes still
+    // visible after the six planes are compacted from the comparison mask.
+
+    __attribute__((target("avx2"))) size_t
+    cull_spheres_avx2(const Frustum::PlanesType &planes, const float *x,
+                      const float *y, const float *z, size_t count,
+                      float radius, Frustum::IndexType *visible_indices)
+    {
+        constexpr size_t LANES = 8;
+        const auto min_distance = _mm256_set1_ps(-radius);
+        size_t visible_count = 0;
+        size_t i = 0;
+        for (; i + LANES <= count; i += LANES)
+        {
+            const auto xs = _mm256_loadu_ps(x + i);
+            const auto ys = _mm256_loadu_ps(y + i);
+            const auto zs = _mm256_loadu_ps(z + i);
+            auto visible = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+            for (const auto &plane : planes)
+            {
+                auto distance = _mm256_mul_ps(_mm256_set1_ps(plane.a), xs);
+                distance = _mm256_add_ps(
+                    distance, _mm256_mul_ps(_mm256_set1_ps(plane.b), ys));
+                distance = _mm256_add_ps(
+                    distance, _mm256_mul_ps(_mm256_set1_ps(plane.c), zs));
+                distance = _mm256_add_ps(distance, _mm256_set1_ps(plane.d));
+                visible = _mm256_and_ps(
+                    visible,
+                    _mm256_cmp_ps(distance, min_distance, _CMP_GE_OQ));
+            }
+
+            unsigned bits = _mm256_movemask_ps(visible);
+            while (bits)
+            {
+                visible_indices[visible_count++] = i + __builtin_ctz(bits);
+                bits &= bits - 1;
+            }
+        }
+        return cull_spheres_scalar(planes, x, y, z, i, count, radius,
+                                   visible_indices, visible_count);
+    }
+} // namespace pogl::kernels
+
+#endif // x86
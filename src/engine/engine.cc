@@ -9,12 +9,39 @@
 #include "inputstate/inputstate.hh"
 #include "object/ground_object.hh"
 #include "object/mesh_renderer.hh"
+#include "particle_system/gpu_particle_system.hh"
 #include "particle_system/particle_system.hh"
 #include "utils/definitions.hh"
 #include "utils/gl_check.hh"
 #include "utils/log.hh"
 
 #define DEFAULT_SCENE 0
+// simulates the snow particles with a compute shader instead of the CPU, set
+// by the POGL_GPU_PARTICLES CMake option
+#ifndef GPU_PARTICLES
+#    define GPU_PARTICLES 0
+#endif // GPU_PARTICLES
+// sorts the GPU particles by depth with a compute shader before drawing
+#define GPU_PARTICLES_SORTED 1
+// snow falls in a box following the camera instead of above the ground
+#define SNOW_FOLLOWS_CAMERA 0
+// snow builds up where the flakes land instead of growing uniformly, CPU
+// particles only
+#define SNOW_DEPOSITION 1
+// snow grows in the ground shader instead of a CPU loop when flakes do not
+// deposit it
+#define ANALYTIC_SNOW 1
+// snow height grows and diffuses in a GPU pass, no CPU height map and no
+// flake deposition
+#define GPU_SNOW 0
+// flakes are carried by a gusting wind, CPU particles only
+#define PARTICLE_WIND 1
+// keeps the particles sorted by grid cell, so that their ground and wind
+// lookups stay local in memory, CPU particles only
+#define PARTICLE_SPATIAL_ORDER 1
+// draws the snow with weighted blended transparency instead of sorting it,
+// CPU particles only
+#define OIT_PARTICLES 0
 
 #if DEFAULT_SCENE
 // enables color
@@ -41,9 +68,20 @@ namespace pogl
         , projection_uniforms()
         , dynamic_objects()
         , main_camera(nullptr)
+        , job_system(nullptr)
+        , transparency_target(nullptr)
         , window(nullptr)
+        , fixed_step(0)
     {}
 
+    bool Engine::_init_jobs()
+    {
+        job_system = std::make_shared<JobSystem>();
+        std::cout << LOG_INFO << "job system running "
+                  << job_system->worker_count() << " worker threads.\n";
+        return true;
+    }
+
     bool Engine::_init_glfw()
     {
         if (!glfwInit())
@@ -149,6 +187,7 @@ namespace pogl
             ground_shader->set_unit_name("snow_height", 0);
             ground_shader->set_unit_name("under_texture", 1);
             ground_shader->set_unit_name("snow_texture", 2);
+            ground_shader->set_unit_name("snow_mask", 3);
             // set up uniforms
             auto up_u = ground_shader->uniform("up");
             if (up_u)
@@ -181,17 +220,53 @@ namespace pogl
             auto snow_texture_u = ground_shader->uniform("snow_texture");
             if (snow_texture_u)
                 snow_texture_u->set_int(2);
-            auto scale_u = ground_shader->uniform("scale");
-            // displacement scale
-            if (scale_u)
-                scale_u->set_float(0.5);
+            auto snow_mask_u = ground_shader->uniform("snow_mask");
+            if (snow_mask_u)
+                snow_mask_u->set_int(3);
+            // the displacement scale is set by the ground builder
         }
         shaders.emplace("ground", ground_shader);
+#if GPU_SNOW
+        shaders.emplace(
+            "snow_simulation",
+            ShaderProgram::make_program(
+                "../resources/ground/shader/simulation_vertex.glsl",
+                "../resources/ground/shader/simulation_fragment.glsl"));
+#endif // GPU_SNOW
         // </ground shader>
 
+#if GPU_PARTICLES
+        auto particles_shader = ShaderProgram::make_program(
+            "../resources/shaders/particle_system/vertex_gpu.glsl",
+            "../resources/shaders/particle_system/fragment.glsl");
+        shaders.emplace("particle_simulation",
+                        ShaderProgram::make_compute_program(
+                            "../resources/shaders/particle_system/"
+                            "simulation.glsl"));
+#    if GPU_PARTICLES_SORTED
+        shaders.emplace("particle_depth_keys",
+                        ShaderProgram::make_compute_program(
+                            "../resources/shaders/particle_system/"
+                            "depth_keys.glsl"));
+        shaders.emplace("particle_sort",
+                        ShaderProgram::make_compute_program(
+                            "../resources/shaders/particle_system/"
+                            "bitonic_sort.glsl"));
+#    endif // GPU_PARTICLES_SORTED
+#elif OIT_PARTICLES
+        auto particles_shader = ShaderProgram::make_program(
+            "../resources/shaders/particle_system/vertex.glsl",
+            "../resources/shaders/particle_system/fragment_oit.glsl");
+        shaders.emplace("oit_composite",
+                        ShaderProgram::make_program(
+                            "../resources/shaders/oit_composite/vertex.glsl",
+                            "../resources/shaders/oit_composite/"
+                            "fragment.glsl"));
+#else
         auto particles_shader = ShaderProgram::make_program(
             "../resources/shaders/particle_system/vertex.glsl",
             "../resources/shaders/particle_system/fragment.glsl");
+#endif // GPU_PARTICLES
         {
             particles_shader->set_unit_name("flocon_texture", 0);
         }
@@ -310,9 +385,10 @@ namespace pogl
         ground_shader->set_texture("snow_texture", snow_tex);
         this->add_texture("snow_texture", snow_tex);
 
+        // reallocated by the ground at the size and precision of its mask
         auto snow_height_tex =
             Texture::builder()
-                .buffer(FloatImageBuffer::sized(1024, 1024, 4))
+                .buffer(FloatImageBuffer::sized(1, 1, 1))
                 .wrap(GL_CLAMP_TO_BORDER)
                 .border(Vector4(0, 0, 0, 1))
                 .src_format(GL_RED)
@@ -364,27 +440,82 @@ namespace pogl
         this->add_renderer(cube_renderer);
 #endif // DEFAULT_SCENE
 
+#if GPU_SNOW
+        constexpr auto accumulation_mode = GroundObject::AccumulationMode::GPU;
+#elif SNOW_DEPOSITION && !GPU_PARTICLES
+        constexpr auto accumulation_mode =
+            GroundObject::AccumulationMode::DEPOSITION;
+#elif ANALYTIC_SNOW
+        constexpr auto accumulation_mode =
+            GroundObject::AccumulationMode::ANALYTIC;
+#else
+        constexpr auto accumulation_mode =
+            GroundObject::AccumulationMode::UNIFORM;
+#endif // GPU_SNOW
         auto ground_option =
             GroundObject::builder()
                 .shader(shaders["ground"])
                 .mask("../resources/ground/textures/snow_mask.png")
                 .model("../resources/ground/model/ground.obj")
                 .accumulation_rate(0.01)
+                .accumulation_mode(accumulation_mode)
+                .precision(HeightMap::Precision::UNORM16)
                 .transform(Matrix4::translation(0, 0, -1))
+#if GPU_SNOW
+                .simulation_shader(shaders["snow_simulation"])
+                // 0.1 of the difference per frame at 60 frames per second
+                .diffusion(6)
+#endif // GPU_SNOW
                 .build();
+        std::shared_ptr<GroundObject> ground = nullptr;
         if (!ground_option)
         {
             std::cerr << LOG_ERROR << "ground could not be built.\n";
         }
         else
         {
-            auto ground = *ground_option;
+            ground = *ground_option;
             this->add_renderer(ground);
             this->add_dynamic(ground);
+            main_camera->set_ground(ground->height_field(), CAMERA_EYE_HEIGHT);
         }
 
+#if GPU_PARTICLES
+        auto particle_sys = std::make_shared<GpuParticleSystem>(
+            shaders["particle_simulation"], shaders["particle_system"], 300, 5);
+#    if GPU_PARTICLES_SORTED
+        particle_sys->set_sort_programs(shaders["particle_depth_keys"],
+                                        shaders["particle_sort"]);
+#    endif // GPU_PARTICLES_SORTED
+#else
         std::shared_ptr<ParticleSystem> particle_sys =
             std::make_shared<ParticleSystem>(shaders["particle_system"], 5);
+#    if SNOW_FOLLOWS_CAMERA
+        particle_sys->followCamera(main_camera, Vector3(4, 4, 3), 600);
+#    endif // SNOW_FOLLOWS_CAMERA
+#    if SNOW_DEPOSITION
+        if (ground)
+        {
+            particle_sys->setGround(ground);
+        }
+#    endif // SNOW_DEPOSITION
+#    if PARTICLE_WIND
+        auto wind = std::make_shared<WindField>(Vector3(0.4, 0.2, 0), 0.6);
+        // updated before the particles it moves
+        this->add_dynamic(wind);
+        particle_sys->setWind(wind);
+#    endif // PARTICLE_WIND
+#    if PARTICLE_SPATIAL_ORDER
+        particle_sys->setSpatialGrid(0.5, 30);
+#    endif // PARTICLE_SPATIAL_ORDER
+#    if OIT_PARTICLES
+        int width, height;
+        glfwGetFramebufferSize(window, &width, &height);
+        transparency_target = std::make_shared<OitFramebuffer>(
+            shaders["oit_composite"], width, height);
+        particle_sys->setTransparencyTarget(transparency_target);
+#    endif // OIT_PARTICLES
+#endif // GPU_PARTICLES
         this->add_renderer(particle_sys);
         this->add_dynamic(particle_sys);
 
@@ -424,6 +555,8 @@ namespace pogl
 
     void Engine::init()
     {
+        std::cout << LOG_INFO << "initialising job system...\n";
+        _init_jobs();
         std::cout << LOG_INFO << "initialising GLFW...\n";
         _init_glfw();
         std::cout << LOG_INFO << "initialising GLEW...\n";
@@ -460,7 +593,7 @@ namespace pogl
         mouse_update();
         static double last_tick = 0;
         const double now = glfwGetTime();
-        const double delta = now - last_tick;
+        const double delta = fixed_step > 0 ? fixed_step : now - last_tick;
         last_tick = now;
 
         // update objects
@@ -503,4 +636,12 @@ namespace pogl
             projection_uniform.set_mat4(projection);
         }
     }
+
+    void Engine::update_framebuffer_size(int width, int height)
+    {
+        if (transparency_target)
+        {
+            transparency_target->resize(width, height);
+        }
+    }
 } // namespace pogl
@@ -9,6 +9,8 @@
 #include <vector>
 
 #include "camera/camera.hh"
+#include "framebuffer/oit_framebuffer.hh"
+#include "jobs/job_system.hh"
 #include "properties/drawable.hh"
 #include "properties/updateable.hh"
 #include "shader_program/shader_program.hh"
@@ -23,6 +25,8 @@ namespace pogl
         static constexpr float DEFAULT_ZNEAR = 0.5;
         static constexpr float DEFAULT_ZFAR = 100.;
         static constexpr float DEFAULT_ASPECT_RATIO = 1.;
+        // lowest height of the camera above the snow covered ground
+        static constexpr float CAMERA_EYE_HEIGHT = 0.3;
 
         static Engine &instance();
         std::vector<std::shared_ptr<Drawable>> renderers;
@@ -33,7 +37,11 @@ namespace pogl
         std::map<std::string, std::shared_ptr<Texture>> textures;
 
         std::shared_ptr<Camera> main_camera;
+        std::shared_ptr<JobSystem> job_system;
+        std::shared_ptr<OitFramebuffer> transparency_target;
         GLFWwindow *window;
+        // frame time given to the objects in seconds, 0 to measure it
+        double fixed_step;
 
         void display();
         void update();
@@ -45,7 +53,17 @@ namespace pogl
 
         void update_perspective(float aspect_ratio);
 
+        /**
+         * @brief Resizes the offscreen targets to the new size of the default
+         * framebuffer.
+         *
+         * @param width
+         * @param height
+         */
+        void update_framebuffer_size(int width, int height);
+
     private:
+        bool _init_jobs();
         bool _init_glfw();
         bool _init_glew();
         bool _init_GL();
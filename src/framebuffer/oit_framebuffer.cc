@@ -0,0 +1,175 @@
+#include "oit_framebuffer.hh"
+
+#include <array>
+#include <stdexcept>
+
+#include "utils/gl_check.hh"
+#include "utils/log.hh"
+
+namespace pogl
+{
+    namespace
+    {
+        constexpr std::array<GLenum, 2> DRAW_BUFFERS = {
+            GL_COLOR_ATTACHMENT0,
+            GL_COLOR_ATTACHMENT1,
+        };
+        constexpr std::array<GLfloat, 4> ACCUMULATION_CLEAR = { 0, 0, 0, 0 };
+        // nothing covers the pixel yet, the background is fully revealed
+        constexpr std::array<GLfloat, 4> REVEALAGE_CLEAR = { 1, 1, 1, 1 };
+
+        std::shared_ptr<Texture> make_target(GLenum format)
+        {
+            GLuint texture_id;
+            glGenTextures(1, &texture_id);
+            CHECK_GL_ERROR();
+            glBindTexture(GL_TEXTURE_2D, texture_id);
+            CHECK_GL_ERROR();
+            // no mipmaps, the composite pass fetches texels directly
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            CHECK_GL_ERROR();
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+            CHECK_GL_ERROR();
+            return std::make_shared<Texture>(texture_id, GL_TEXTURE_2D, format);
+        }
+    } // namespace
+
+    OitFramebuffer::OitFramebuffer(std::shared_ptr<ShaderProgram> composite,
+                                   GLsizei width, GLsizei height)
+        : _composite(composite)
+        , _accumulation(make_target(GL_RGBA16F))
+        , _revealage(make_target(GL_R8))
+        , _framebuffer_id(0)
+        , _depth_id(0)
+        , _vao(0)
+        , _width(width)
+        , _height(height)
+    {
+        glGenFramebuffers(1, &_framebuffer_id);
+        CHECK_GL_ERROR();
+        glGenRenderbuffers(1, &_depth_id);
+        CHECK_GL_ERROR();
+        // core profile requires a bound VAO to draw, even without attributes
+        glGenVertexArrays(1, &_vao);
+        CHECK_GL_ERROR();
+        allocate();
+
+        glBindFramebuffer(GL_FRAMEBUFFER, _framebuffer_id);
+        CHECK_GL_ERROR();
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                               GL_TEXTURE_2D, _accumulation->id(), 0);
+        CHECK_GL_ERROR();
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1,
+                               GL_TEXTURE_2D, _revealage->id(), 0);
+        CHECK_GL_ERROR();
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT,
+                                  GL_RENDERBUFFER, _depth_id);
+        CHECK_GL_ERROR();
+        glDrawBuffers(DRAW_BUFFERS.size(), DRAW_BUFFERS.data());
+        CHECK_GL_ERROR();
+        const auto status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+        CHECK_GL_ERROR();
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        CHECK_GL_ERROR();
+        if (status != GL_FRAMEBUFFER_COMPLETE)
+        {
+            std::cerr << LOG_ERROR << "transparency framebuffer is incomplete ("
+                      << status << ")" << std::endl;
+            throw std::logic_error("Incomplete transparency framebuffer");
+        }
+
+        _composite->set_texture(ACCUMULATION_UNIT, _accumulation);
+        _composite->set_texture(REVEALAGE_UNIT, _revealage);
+        auto accumulation_u = _composite->uniform("accumulation");
+        if (accumulation_u)
+            accumulation_u->set_int(ACCUMULATION_UNIT);
+        auto revealage_u = _composite->uniform("revealage");
+        if (revealage_u)
+            revealage_u->set_int(REVEALAGE_UNIT);
+    }
+
+    OitFramebuffer::~OitFramebuffer()
+    {
+        glDeleteVertexArrays(1, &_vao);
+        CHECK_GL_ERROR();
+        glDeleteRenderbuffers(1, &_depth_id);
+        CHECK_GL_ERROR();
+        glDeleteFramebuffers(1, &_framebuffer_id);
+        CHECK_GL_ERROR();
+    }
+
+    void OitFramebuffer::resize(GLsizei width, GLsizei height)
+    {
+        _width = width;
+        _height = height;
+        // attachments keep their names, only their storage changes
+        allocate();
+    }
+
+    void OitFramebuffer::allocate()
+    {
+        _accumulation->allocate(_width, _height, GL_RGBA, GL_HALF_FLOAT);
+        _revealage->allocate(_width, _height, GL_RED, GL_UNSIGNED_BYTE);
+        // same format as the default depth buffer, blits between depth
+        // buffers of different formats are invalid
+        glBindRenderbuffer(GL_RENDERBUFFER, _depth_id);
+        CHECK_GL_ERROR();
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, _width,
+                              _height);
+        CHECK_GL_ERROR();
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+        CHECK_GL_ERROR();
+    }
+
+    void OitFramebuffer::begin()
+    {
+        // transparent fragments behind opaque geometry must still be
+        // rejected, so the opaque depth is tested but never written
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+        CHECK_GL_ERROR();
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, _framebuffer_id);
+        CHECK_GL_ERROR();
+        glBlitFramebuffer(0, 0, _width, _height, 0, 0, _width, _height,
+                          GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+        CHECK_GL_ERROR();
+        glBindFramebuffer(GL_FRAMEBUFFER, _framebuffer_id);
+        CHECK_GL_ERROR();
+        glClearBufferfv(GL_COLOR, 0, ACCUMULATION_CLEAR.data());
+        CHECK_GL_ERROR();
+        glClearBufferfv(GL_COLOR, 1, REVEALAGE_CLEAR.data());
+        CHECK_GL_ERROR();
+
+        glDepthMask(GL_FALSE);
+        CHECK_GL_ERROR();
+        // sum of the weighted colors, product of the transmittances
+        glBlendFunci(0, GL_ONE, GL_ONE);
+        CHECK_GL_ERROR();
+        glBlendFunci(1, GL_ZERO, GL_ONE_MINUS_SRC_COLOR);
+        CHECK_GL_ERROR();
+    }
+
+    void OitFramebuffer::end()
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        CHECK_GL_ERROR();
+        glDepthMask(GL_TRUE);
+        CHECK_GL_ERROR();
+        // the composite outputs the average color with an alpha of
+        // 1 - revealage, which the engine blending puts over the scene
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        CHECK_GL_ERROR();
+        glDisable(GL_DEPTH_TEST);
+        CHECK_GL_ERROR();
+
+        _composite->use();
+        glBindVertexArray(_vao);
+        CHECK_GL_ERROR();
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        CHECK_GL_ERROR();
+        glBindVertexArray(0);
+        CHECK_GL_ERROR();
+
+        glEnable(GL_DEPTH_TEST);
+        CHECK_GL_ERROR();
+    }
+} // namespace pogl
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <memory>
+
+#include "shader_program/shader_program.hh"
+#include "texture/texture.hh"
+
+namespace pogl
+{
+    /**
+     * @brief Render target of weighted blended order-independent
+     * transparency.
+     *
+     * Transparent geometry drawn between begin() and end() is accumulated
+     * into a premultiplied RGBA16F sum and an R8 revealage product, which
+     * are both commutative, so the draw order no longer matters. end()
+     * composites the weighted average over the default framebuffer.
+     */
+    class OitFramebuffer
+    {
+    public:
+        /**
+         * @brief Texture units the composite program reads the targets from
+         */
+        static constexpr int ACCUMULATION_UNIT = 0;
+        static constexpr int REVEALAGE_UNIT = 1;
+
+        /**
+         * @brief Creates the targets at the size of the default framebuffer.
+         *
+         * @param composite program drawing a full screen triangle which
+         * resolves the accumulation and revealage textures
+         * @param width
+         * @param height
+         */
+        OitFramebuffer(std::shared_ptr<ShaderProgram> composite, GLsizei width,
+                       GLsizei height);
+        ~OitFramebuffer();
+
+        OitFramebuffer(const OitFramebuffer &) = delete;
+        OitFramebuffer &operator=(const OitFramebuffer &) = delete;
+
+        /**
+         * @brief Reallocates the targets, to be called when the default
+         * framebuffer is resized.
+         *
+         * @param width
+         * @param height
+         */
+        void resize(GLsizei width, GLsizei height);
+
+        /**
+         * @brief Copies the opaque depth, clears the targets and sets up
+         * the accumulation blending. Depth writes are disabled until end().
+         */
+        void begin();
+
+        /**
+         * @brief Restores the engine blending and depth state, then blends
+         * the transparent layer over the default framebuffer.
+         */
+        void end();
+
+    private:
+        void allocate();
+
+        std::shared_ptr<ShaderProgram> _composite;
+        std::shared_ptr<Texture> _accumulation;
+        std::shared_ptr<Texture> _revealage;
+        GLuint _framebuffer_id;
+        GLuint _depth_id;
+        GLuint _vao;
+        GLsizei _width;
+        GLsizei _height;
+    };
+} // namespace pogl
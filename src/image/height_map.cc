@@ -0,0 +1,180 @@
+#include "height_map.hh"
+
+#include <algorithm>
+#include <cmath>
+
+namespace pogl
+{
+    HeightMap::HeightMap()
+        : HeightMap(0, 0, Precision::FLOAT32)
+    {}
+
+    HeightMap::HeightMap(DimensionType width, DimensionType height,
+                         Precision precision)
+        : _texels(RGBImageBuffer::BufferType(
+                      (size_t)width * height * texel_size(precision)
+                      + GATHER_PADDING),
+                  width, height, texel_size(precision))
+        , _precision(precision)
+    {}
+
+    HeightMap HeightMap::from_image(const FloatImageBuffer &image,
+                                    Precision precision)
+    {
+        auto map = HeightMap(image.width(), image.height(), precision);
+        const auto *pixels = image.data();
+        const size_t count = image.width() * image.height();
+        for (size_t i = 0; i < count; ++i)
+        {
+            map.set(i, pixels[i * image.channels()]);
+        }
+        return map;
+    }
+
+    size_t HeightMap::texel_size(Precision precision)
+    {
+        switch (precision)
+        {
+        case Precision::UNORM8:
+            return 1;
+        case Precision::UNORM16:
+        case Precision::FLOAT16:
+            return 2;
+        default:
+            return 4;
+        }
+    }
+
+    float HeightMap::step(Precision precision)
+    {
+        switch (precision)
+        {
+        case Precision::UNORM8:
+            return 1.f / 255;
+        case Precision::UNORM16:
+            return 1.f / 65535;
+        case Precision::FLOAT16:
+            // multiples of 2^-10 below 2 fit in the 11 bit significand
+            return 0x1p-10f;
+        default:
+            return 0;
+        }
+    }
+
+    float HeightMap::quantize(float amount) const
+    {
+        const auto unit = step(_precision);
+        if (unit == 0)
+        {
+            return amount;
+        }
+        return std::floor(amount / unit) * unit;
+    }
+
+    GLenum HeightMap::internal_format() const
+    {
+        switch (_precision)
+        {
+        case Precision::UNORM8:
+            return GL_R8;
+        case Precision::UNORM16:
+            return GL_R16;
+        case Precision::FLOAT16:
+            return GL_R16F;
+        default:
+            return GL_R32F;
+        }
+    }
+
+    GLenum HeightMap::pixel_type() const
+    {
+        switch (_precision)
+        {
+        case Precision::UNORM8:
+            return GL_UNSIGNED_BYTE;
+        case Precision::UNORM16:
+            return GL_UNSIGNED_SHORT;
+        case Precision::FLOAT16:
+            return GL_HALF_FLOAT;
+        default:
+            return GL_FLOAT;
+        }
+    }
+
+    void HeightMap::set(size_t index, float value)
+    {
+        auto *texels = _texels.data();
+        switch (_precision)
+        {
+        case Precision::UNORM8:
+            texels[index] = (std::uint8_t)std::lround(
+                std::clamp(value, 0.f, 1.f) * 255);
+            break;
+        case Precision::UNORM16: {
+            const auto texel = (std::uint16_t)std::lround(
+                std::clamp(value, 0.f, 1.f) * 65535);
+            std::memcpy(texels + 2 * index, &texel, 2);
+            break;
+        }
+        case Precision::FLOAT16: {
+            const auto texel = float_to_half(value);
+            std::memcpy(texels + 2 * index, &texel, 2);
+            break;
+        }
+        default:
+            std::memcpy(texels + 4 * index, &value, 4);
+            break;
+        }
+    }
+
+    std::byte *HeightMap::data()
+    {
+        return reinterpret_cast<std::byte *>(_texels.data());
+    }
+
+    const std::byte *HeightMap::data() const
+    {
+        return reinterpret_cast<const std::byte *>(_texels.data());
+    }
+
+    HeightMap::DimensionType HeightMap::width() const
+    {
+        return _texels.width();
+    }
+
+    HeightMap::DimensionType HeightMap::height() const
+    {
+        return _texels.height();
+    }
+
+    HeightMap::Precision HeightMap::precision() const
+    {
+        return _precision;
+    }
+
+    size_t HeightMap::texel_size() const
+    {
+        return texel_size(_precision);
+    }
+
+    bool HeightMap::empty() const
+    {
+        // the texels always hold the gather padding
+        return width() == 0 || height() == 0;
+    }
+
+    void HeightMap::mark_dirty(const Region &region)
+    {
+        _texels.mark_dirty(region);
+    }
+
+    void HeightMap::mark_all_dirty()
+    {
+        _texels.mark_all_dirty();
+    }
+
+    std::vector<HeightMap::Region> HeightMap::take_dirty_regions()
+    {
+        return _texels.take_dirty_regions();
+    }
+} // namespace pogl
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "image_buffer.hh"
+#include "utils/half.hh"
+
+namespace pogl
+{
+    /**
+     * @brief Single plane of heights stored at a chosen precision.
+     *
+     * Unorm precisions hold heights in [0, 1] in 8 or 16 bits, like the R8
+     * and R16 texture formats, float precisions hold any height. Texels are
+     * stored in the layout of the matching texture format, so regions are
+     * uploaded without conversion. Changed tiles are tracked like in
+     * ImageBuffer.
+     */
+    class HeightMap
+    {
+    public:
+        enum class Precision
+        {
+            UNORM8,
+            UNORM16,
+            FLOAT16,
+            FLOAT32,
+        };
+
+        using Region = ImageRegion;
+        using DimensionType = int;
+
+        static constexpr DimensionType TILE_SIZE = RGBImageBuffer::TILE_SIZE;
+        /**
+         * @brief Bytes allocated past the last texel, so that 32-bit gathers
+         * of 16-bit texels never read out of the storage
+         */
+        static constexpr size_t GATHER_PADDING = 2;
+
+        HeightMap();
+        /**
+         * @brief Map of zero heights
+         *
+         * @param width
+         * @param height
+         * @param precision
+         */
+        HeightMap(DimensionType width, DimensionType height,
+                  Precision precision);
+
+        /**
+         * @brief Map of the first channel of image
+         *
+         * @param image
+         * @param precision
+         * @return HeightMap
+         */
+        static HeightMap from_image(const FloatImageBuffer &image,
+                                    Precision precision);
+
+        /**
+         * @brief Bytes per texel of a precision
+         *
+         * @param precision
+         * @return size_t
+         */
+        static size_t texel_size(Precision precision);
+
+        /**
+         * @brief Smallest increment kept exactly by every height in [0, 1],
+         * 0 when any increment is. Heights only grow by multiples of it,
+         * see quantize.
+         *
+         * @param precision
+         * @return float
+         */
+        static float step(Precision precision);
+
+        /**
+         * @brief Largest multiple of step not above amount
+         *
+         * @param amount
+         * @return float
+         */
+        float quantize(float amount) const;
+
+        /**
+         * @brief Sized internal format of the matching texture
+         *
+         * @return GLenum e.g. GL_R16
+         */
+        GLenum internal_format() const;
+
+        /**
+         * @brief Pixel type of the texels, with GL_RED as format
+         *
+         * @return GLenum e.g. GL_UNSIGNED_SHORT
+         */
+        GLenum pixel_type() const;
+
+        /**
+         * @brief Height of texel index, counted in row major order
+         *
+         * @param index
+         * @return float
+         */
+        float get(size_t index) const;
+
+        /**
+         * @brief Height of texel index of raw texels, for kernels reading
+         * maps through pointers
+         *
+         * @param texels
+         * @param precision
+         * @param index
+         * @return float
+         */
+        static float decode(const std::byte *texels, Precision precision,
+                            size_t index);
+
+        /**
+         * @brief Rounds value to the precision, unorm clamps to [0, 1]
+         *
+         * @param index
+         * @param value
+         */
+        void set(size_t index, float value);
+
+        std::byte *data();
+        const std::byte *data() const;
+
+        DimensionType width() const;
+        DimensionType height() const;
+        Precision precision() const;
+        size_t texel_size() const;
+        bool empty() const;
+
+        /**
+         * @brief See ImageBuffer::mark_dirty
+         */
+        void mark_dirty(const Region &region);
+        void mark_all_dirty();
+        std::vector<Region> take_dirty_regions();
+
+    private:
+        // one byte channel per byte of texel, for the tile tracking
+        RGBImageBuffer _texels;
+        Precision _precision;
+    };
+
+    inline float HeightMap::decode(const std::byte *texels,
+                                   Precision precision, size_t index)
+    {
+        switch (precision)
+        {
+        case Precision::UNORM8:
+            return std::to_integer<int>(texels[index]) * (1.f / 255);
+        case Precision::UNORM16: {
+            std::uint16_t value;
+            std::memcpy(&value, texels + 2 * index, 2);
+            return value * (1.f / 65535);
+        }
+        case Precision::FLOAT16: {
+            std::uint16_t value;
+            std::memcpy(&value, texels + 2 * index, 2);
+            return half_to_float(value);
+        }
+        default: {
+            float value;
+            std::memcpy(&value, texels + 4 * index, 4);
+            return value;
+        }
+        }
+    }
+
+    inline float HeightMap::get(size_t index) const
+    {
+        return decode(data(), _precision, index);
+    }
+} // namespace pogl
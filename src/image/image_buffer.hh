@@ -1,6 +1,7 @@
 #pragma once
 
 #include <GL/glew.h>
+#include <cstdint>
 #include <filesystem>
 #include <optional>
 #include <stddef.h>
@@ -10,6 +11,17 @@ namespace pogl
 {
     namespace fs = std::filesystem;
 
+    /**
+     * @brief Rectangle of pixels
+     */
+    struct ImageRegion
+    {
+        int x;
+        int y;
+        int width;
+        int height;
+    };
+
     template <typename PixelValueType = unsigned char>
     class ImageBuffer
     {
@@ -21,6 +33,13 @@ namespace pogl
         using ConstPixelType = const BufferElemType *;
         using DimensionType = int;
 
+        /**
+         * @brief Edge of the square tiles in which changes are tracked
+         */
+        static constexpr DimensionType TILE_SIZE = 64;
+
+        using Region = ImageRegion;
+
         ImageBuffer(BufferType bytes, DimensionType width, DimensionType height,
                     DimensionType channels);
         ImageBuffer();
@@ -49,6 +68,24 @@ namespace pogl
         const DimensionType &height() const;
         const DimensionType &channels() const;
 
+        /**
+         * @brief Marks the tiles overlapping region as changed, to be
+         * uploaded again. Every tile has its own flag: jobs marking
+         * different tiles may run concurrently.
+         *
+         * @param region clipped to the image
+         */
+        void mark_dirty(const Region &region);
+        void mark_all_dirty();
+
+        /**
+         * @brief Returns the tiles changed since the last call, clipped to the
+         * image and in row major order, and forgets them.
+         *
+         * @return std::vector<Region>
+         */
+        std::vector<Region> take_dirty_regions();
+
     private:
         Self &width(DimensionType value);
         Self &height(DimensionType value);
@@ -61,6 +98,10 @@ namespace pogl
         DimensionType _channels;
         DimensionType _line_stride;
         DimensionType _size;
+        DimensionType _tiles_x;
+        DimensionType _tiles_y;
+        // one flag per tile, row major
+        std::vector<std::uint8_t> _dirty_tiles;
     };
 
     using RGBImageBuffer = ImageBuffer<unsigned char>;
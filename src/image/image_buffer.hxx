@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <iostream>
 #include <stdexcept>
 
@@ -24,6 +25,9 @@ namespace pogl
         , _channels(channels)
         , _line_stride(width * channels)
         , _size(width * height * channels)
+        , _tiles_x((width + TILE_SIZE - 1) / TILE_SIZE)
+        , _tiles_y((height + TILE_SIZE - 1) / TILE_SIZE)
+        , _dirty_tiles(_tiles_x * _tiles_y, 0)
     {}
 
     template <typename T>
@@ -149,6 +153,55 @@ namespace pogl
         return _channels;
     }
 
+    template <typename T>
+    void ImageBuffer<T>::mark_dirty(const Region &region)
+    {
+        const auto first_x = std::max(region.x, 0);
+        const auto first_y = std::max(region.y, 0);
+        const auto end_x = std::min(region.x + region.width, _width);
+        const auto end_y = std::min(region.y + region.height, _height);
+        if (first_x >= end_x || first_y >= end_y)
+        {
+            return;
+        }
+        for (auto tile_y = first_y / TILE_SIZE;
+             tile_y <= (end_y - 1) / TILE_SIZE; ++tile_y)
+        {
+            for (auto tile_x = first_x / TILE_SIZE;
+                 tile_x <= (end_x - 1) / TILE_SIZE; ++tile_x)
+            {
+                _dirty_tiles[tile_y * _tiles_x + tile_x] = 1;
+            }
+        }
+    }
+
+    template <typename T>
+    void ImageBuffer<T>::mark_all_dirty()
+    {
+        std::fill(_dirty_tiles.begin(), _dirty_tiles.end(), 1);
+    }
+
+    template <typename T>
+    std::vector<typename ImageBuffer<T>::Region>
+    ImageBuffer<T>::take_dirty_regions()
+    {
+        auto regions = std::vector<Region>();
+        for (DimensionType tile = 0; tile < (DimensionType)_dirty_tiles.size();
+             ++tile)
+        {
+            if (!_dirty_tiles[tile])
+            {
+                continue;
+            }
+            _dirty_tiles[tile] = 0;
+            const auto x = (tile % _tiles_x) * TILE_SIZE;
+            const auto y = (tile / _tiles_x) * TILE_SIZE;
+            regions.push_back(Region{ x, y, std::min(TILE_SIZE, _width - x),
+                                      std::min(TILE_SIZE, _height - y) });
+        }
+        return regions;
+    }
+
     template <typename T>
     ImageBuffer<T> &ImageBuffer<T>::width(DimensionType value)
     {
@@ -175,5 +228,8 @@ namespace pogl
     {
         _line_stride = _width * _channels;
         _size = _width * _height * _channels;
+        _tiles_x = (_width + TILE_SIZE - 1) / TILE_SIZE;
+        _tiles_y = (_height + TILE_SIZE - 1) / TILE_SIZE;
+        _dirty_tiles.assign(_tiles_x * _tiles_y, 0);
     }
 } // namespace pogl
@@ -0,0 +1,164 @@
+#include "job_system.hh"
+
+#include <algorithm>
+
+namespace pogl
+{
+    namespace
+    {
+        constexpr size_t NOT_A_WORKER = static_cast<size_t>(-1);
+        // index of the current thread's queue in its owning job system
+        thread_local size_t current_worker = NOT_A_WORKER;
+        thread_local const JobSystem *current_owner = nullptr;
+    } // namespace
+
+    JobSystem::Counter::Counter()
+        : _pending(0)
+    {}
+
+    bool JobSystem::Counter::done() const
+    {
+        return _pending.load(std::memory_order_acquire) == 0;
+    }
+
+    JobSystem::JobSystem(size_t worker_count)
+        : _queues()
+        , _workers()
+        , _queued(0)
+        , _next_queue(0)
+        , _stopping(false)
+        , _sleep_mutex()
+        , _wake()
+    {
+        for (size_t i = 0; i < std::max<size_t>(worker_count, 1); ++i)
+        {
+            _queues.push_back(std::make_unique<WorkerQueue>());
+        }
+        for (size_t i = 0; i < worker_count; ++i)
+        {
+            _workers.emplace_back([this, i]() { worker_loop(i); });
+        }
+    }
+
+    JobSystem::~JobSystem()
+    {
+        {
+            std::lock_guard lock(_sleep_mutex);
+            _stopping = true;
+        }
+        _wake.notify_all();
+        for (auto &worker : _workers)
+        {
+            worker.join();
+        }
+    }
+
+    size_t JobSystem::default_worker_count()
+    {
+        const size_t hardware_threads = std::thread::hardware_concurrency();
+        return hardware_threads > 1 ? hardware_threads - 1 : 0;
+    }
+
+    size_t JobSystem::worker_count() const
+    {
+        return _workers.size();
+    }
+
+    void JobSystem::submit(JobType job, Counter &counter)
+    {
+        counter._pending.fetch_add(1, std::memory_order_relaxed);
+        const auto queue_index = current_owner == this
+            ? current_worker
+            : _next_queue.fetch_add(1, std::memory_order_relaxed)
+                % _queues.size();
+        {
+            auto &queue = *_queues[queue_index];
+            std::lock_guard lock(queue.mutex);
+            queue.jobs.push_back(Job{ std::move(job), &counter });
+        }
+        _queued.fetch_add(1, std::memory_order_release);
+        {
+            // a worker checking _queued holds this mutex until it sleeps, so
+            // taking it here ensures the notification cannot be missed
+            std::lock_guard lock(_sleep_mutex);
+        }
+        _wake.notify_one();
+    }
+
+    void JobSystem::wait(Counter &counter)
+    {
+        const auto first_victim = current_owner == this ? current_worker : 0;
+        while (!counter.done())
+        {
+            Job job;
+            if (try_steal(first_victim, job))
+            {
+                run(job);
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    bool JobSystem::try_pop(size_t queue_index, Job &job)
+    {
+        auto &queue = *_queues[queue_index];
+        std::lock_guard lock(queue.mutex);
+        if (queue.jobs.empty())
+        {
+            return false;
+        }
+        job = std::move(queue.jobs.back());
+        queue.jobs.pop_back();
+        _queued.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    bool JobSystem::try_steal(size_t first_victim, Job &job)
+    {
+        for (size_t i = 0; i < _queues.size(); ++i)
+        {
+            auto &queue = *_queues[(first_victim + i) % _queues.size()];
+            std::lock_guard lock(queue.mutex);
+            if (!queue.jobs.empty())
+            {
+                job = std::move(queue.jobs.front());
+                queue.jobs.pop_front();
+                _queued.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void JobSystem::run(Job &job)
+    {
+        job.function();
+        job.counter->_pending.fetch_sub(1, std::memory_order_release);
+    }
+
+    void JobSystem::worker_loop(size_t index)
+    {
+        current_worker = index;
+        current_owner = this;
+        while (true)
+        {
+            Job job;
+            if (try_pop(index, job) || try_steal(index + 1, job))
+            {
+                run(job);
+                continue;
+            }
+            std::unique_lock lock(_sleep_mutex);
+            _wake.wait(lock, [this]() {
+                return _stopping || _queued.load(std::memory_order_acquire) > 0;
+            });
+            if (_stopping && _queued.load(std::memory_order_acquire) == 0)
+            {
+                return;
+            }
+        }
+    }
+} // namespace pogl
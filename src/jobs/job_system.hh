@@ -0,0 +1,122 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace pogl
+{
+    /**
+     * @brief Pool of worker threads executing small jobs.
+     *
+     * Every worker owns a queue: it pops its own jobs from the back and, once
+     * it runs dry, steals from the front of the other queues. A thread
+     * waiting on a batch keeps running queued jobs instead of blocking.
+     * Jobs must not throw.
+     */
+    class JobSystem
+    {
+    public:
+        using JobType = std::function<void()>;
+
+        /**
+         * @brief Number of unfinished jobs of a batch, see JobSystem::wait
+         */
+        class Counter
+        {
+        public:
+            Counter();
+
+            bool done() const;
+
+        private:
+            friend class JobSystem;
+            std::atomic<size_t> _pending;
+        };
+
+        /**
+         * @brief Starts worker_count threads, 0 runs every job on the
+         * waiting thread.
+         *
+         * @param worker_count
+         */
+        explicit JobSystem(size_t worker_count = default_worker_count());
+        ~JobSystem();
+
+        JobSystem(const JobSystem &) = delete;
+        JobSystem &operator=(const JobSystem &) = delete;
+
+        /**
+         * @brief One worker per hardware thread, minus the main thread
+         * which takes part in the work while waiting.
+         *
+         * @return size_t
+         */
+        static size_t default_worker_count();
+
+        size_t worker_count() const;
+
+        /**
+         * @brief Queues job, counter is decremented once it has run
+         *
+         * @param job
+         * @param counter
+         */
+        void submit(JobType job, Counter &counter);
+
+        /**
+         * @brief Runs queued jobs until every job counted by counter is done
+         *
+         * @param counter
+         */
+        void wait(Counter &counter);
+
+        /**
+         * @brief Splits [0; count) in chunks of chunk_size elements and calls
+         * `function(chunk_index, begin, end)` once per chunk, in parallel.
+         * Chunk boundaries only depend on count and chunk_size, never on the
+         * number of workers. Returns once every chunk is processed.
+         *
+         * @param count number of elements
+         * @param chunk_size number of elements per chunk
+         * @param function
+         */
+        template <typename Function>
+        void parallel_for(size_t count, size_t chunk_size,
+                          Function &&function);
+
+    private:
+        struct Job
+        {
+            JobType function;
+            Counter *counter;
+        };
+
+        struct WorkerQueue
+        {
+            std::mutex mutex;
+            std::deque<Job> jobs;
+        };
+
+        bool try_pop(size_t queue, Job &job);
+        bool try_steal(size_t first_victim, Job &job);
+        void run(Job &job);
+        void worker_loop(size_t index);
+
+        std::vector<std::unique_ptr<WorkerQueue>> _queues;
+        std::vector<std::thread> _workers;
+        std::atomic<size_t> _queued;
+        std::atomic<size_t> _next_queue;
+        std::atomic<bool> _stopping;
+        std::mutex _sleep_mutex;
+        std::condition_variable _wake;
+    };
+} // namespace pogl
+
+#include "job_system.hxx"
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <algorithm>
+
+#include "job_system.hh"
+
+namespace pogl
+{
+    template <typename Function>
+    void JobSystem::parallel_for(size_t count, size_t chunk_size,
+                                 Function &&function)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+        chunk_size = std::max<size_t>(chunk_size, 1);
+        const size_t chunk_count = (count + chunk_size - 1) / chunk_size;
+        if (chunk_count == 1 || _workers.empty())
+        {
+            for (size_t chunk = 0; chunk < chunk_count; ++chunk)
+            {
+                const auto begin = chunk * chunk_size;
+                function(chunk, begin, std::min(count, begin + chunk_size));
+            }
+            return;
+        }
+
+        Counter counter;
+        for (size_t chunk = 1; chunk < chunk_count; ++chunk)
+        {
+            const auto begin = chunk * chunk_size;
+            const auto end = std::min(count, begin + chunk_size);
+            submit([&function, chunk, begin,
+                    end]() { function(chunk, begin, end); },
+                   counter);
+        }
+        // the calling thread takes the first chunk then helps with the rest
+        function(0, 0, std::min(count, chunk_size));
+        wait(counter);
+    }
+} // namespace pogl
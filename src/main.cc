@@ -5,6 +5,7 @@
 
 #include "engine/engine.hh"
 #include "utils/log.hh"
+#include "utils/rng.hh"
 #include "image/stb_image.h"
 
 using namespace pogl;
@@ -19,9 +20,16 @@ std::string toupper(const std::string &in)
 
 int main()
 {
-    std::srand(std::time(nullptr));
+    const auto seed = environment_seed();
+    set_global_seed(seed);
+    std::cout << LOG_INFO << "random seed: " << seed << "\n";
     stbi_set_flip_vertically_on_load(true);
     auto &engine = Engine::instance();
+    engine.fixed_step = environment_fixed_step();
+    if (engine.fixed_step > 0)
+        std::cout << LOG_INFO << "fixed step: " << engine.fixed_step
+                  << "s (same POGL_SEED and POGL_FIXED_STEP reproduce the "
+                     "run)\n";
     engine.init();
     std::cout << LOG_INFO << "launching\n";
     std::cout << "Camera controls:\n";
@@ -1,6 +1,13 @@
 #include "ground_object.hh"
 
+#include <algorithm>
 #include <cmath>
+#include <iostream>
+#include <stdexcept>
+
+#include "engine/engine.hh"
+#include "snow_accumulation.hh"
+#include "utils/log.hh"
 
 namespace pogl
 {
@@ -10,16 +17,94 @@ namespace pogl
     }
 
     GroundObject::GroundObject(RendererType renderer,
-                               const FloatImageBuffer &snow_mask,
+                               const HeightMap &snow_mask,
                                std::shared_ptr<Texture> snow_height_texture,
-                               float accumulation_rate)
+                               std::shared_ptr<GroundProjection> projection,
+                               AccumulationMode mode, float accumulation_rate,
+                               const DepositionSettings &deposition,
+                               float displacement_scale,
+                               std::shared_ptr<SnowSimulation> simulation)
         : _renderer(renderer)
-        , _snow_mask(snow_mask)
-        , _snow_height(FloatImageBuffer::sized(
-              snow_mask.width(), snow_mask.height(), snow_mask.channels()))
+        , _snow_mask(std::make_shared<HeightMap>(snow_mask))
+        , _snow_height(mode == AccumulationMode::GPU
+                           ? std::make_shared<HeightMap>()
+                           : std::make_shared<HeightMap>(
+                               snow_mask.width(), snow_mask.height(),
+                               snow_mask.precision()))
         , _snow_height_texture(snow_height_texture)
         , _accumulation_rate(accumulation_rate)
-    {}
+        , _accumulation_mode(mode)
+        , _pending_snow(0)
+        , _snow_time(0)
+        , _full_snow_time(0)
+        , _snow_time_uniform(std::nullopt)
+        , _projection(projection)
+        , _height_field(nullptr)
+        , _deposition(nullptr)
+        , _simulation(simulation)
+        , _readback_time(0)
+        , _capped_bands()
+    {
+        if (mode == AccumulationMode::GPU)
+        {
+            if (!_simulation)
+            {
+                std::cerr << LOG_ERROR
+                          << "GPU snow accumulation needs a snow simulation"
+                          << std::endl;
+                throw std::logic_error("Missing snow simulation");
+            }
+        }
+        else
+        {
+            // storage of the size of the mask, later updates only touch the
+            // changed tiles
+            _snow_height_texture->set_image(*_snow_height);
+        }
+
+        if (_projection)
+        {
+            std::shared_ptr<const HeightMap> snow_height =
+                mode == AccumulationMode::GPU ? _simulation->heights()
+                                              : _snow_height;
+            _height_field = std::make_shared<HeightField>(
+                *_projection, snow_height, _snow_mask, displacement_scale);
+            if (mode == AccumulationMode::DEPOSITION
+                || mode == AccumulationMode::ANALYTIC)
+            {
+                _deposition = std::make_unique<SnowDeposition>(
+                    _snow_height->width(), _snow_height->height(),
+                    deposition.peak_height, deposition.radius);
+            }
+        }
+
+        if (mode == AccumulationMode::UNIFORM)
+        {
+            constexpr auto BAND_ROWS = HeightMap::TILE_SIZE;
+            _capped_bands.assign(
+                (_snow_height->height() + BAND_ROWS - 1) / BAND_ROWS, 0);
+        }
+        else if (mode == AccumulationMode::ANALYTIC)
+        {
+            // past this time every texel is capped by the mask
+            float highest = 0;
+            const size_t count = _snow_mask->width() * _snow_mask->height();
+            for (size_t i = 0; i < count; ++i)
+            {
+                highest = std::max(highest, _snow_mask->get(i));
+            }
+            if (accumulation_rate > 0)
+            {
+                _full_snow_time = highest / accumulation_rate;
+            }
+
+            auto shader = _renderer->shader();
+            _snow_time_uniform = shader->uniform("snow_time");
+            auto rate_u = shader->uniform("accumulation_rate");
+            if (rate_u)
+                rate_u->set_float(accumulation_rate);
+        }
+    }
 
     void GroundObject::draw()
     {
@@ -28,18 +113,149 @@ namespace pogl
 
     void GroundObject::update(double delta)
     {
-        auto accumulation = delta * _accumulation_rate;
-        for (int y = 0; y < _snow_height.height(); ++y)
+        if (_accumulation_mode == AccumulationMode::GPU)
+        {
+            _simulation->step(delta * _accumulation_rate, delta);
+            _renderer->shader()->set_texture("snow_height",
+                                             _simulation->current());
+            _simulation->poll_readback();
+            _readback_time += delta;
+            if (_readback_time >= READBACK_INTERVAL)
+            {
+                _readback_time = 0;
+                _simulation->request_readback();
+            }
+            return;
+        }
+        if (_accumulation_mode == AccumulationMode::ANALYTIC)
+        {
+            if (_snow_time < _full_snow_time)
+            {
+                _snow_time = std::min<float>(_snow_time + delta,
+                                             _full_snow_time);
+                if (_snow_time_uniform)
+                    _snow_time_uniform->set_float(_snow_time);
+                if (_height_field)
+                    _height_field->set_snow_level(_snow_time
+                                                  * _accumulation_rate);
+            }
+            upload_dirty_tiles();
+            return;
+        }
+        if (_accumulation_mode == AccumulationMode::DEPOSITION)
+        {
+            upload_dirty_tiles();
+            return;
+        }
+
+        // growth below the precision of the map waits for the next frames
+        _pending_snow += delta * _accumulation_rate;
+        const auto amount = _snow_height->quantize(_pending_snow);
+        _pending_snow -= amount;
+        if (amount <= 0)
+        {
+            return;
+        }
+
+        // whole rows at a time, in bands of tile rows so that no two jobs
+        // mark the same tile. A band capped by the mask never changes again.
+        Engine::instance().job_system->parallel_for(
+            _snow_height->height(), HeightMap::TILE_SIZE,
+            [&](size_t band, size_t begin, size_t end) {
+                if (_capped_bands[band])
+                {
+                    return;
+                }
+                bool capped = true;
+                for (auto y = begin; y < end; ++y)
+                {
+                    const auto span =
+                        accumulate_snow(*_snow_height, *_snow_mask, y, amount);
+                    capped = capped && span.capped;
+                    if (span.first < span.end)
+                    {
+                        _snow_height->mark_dirty({ (int)span.first, (int)y,
+                                                  (int)(span.end - span.first),
+                                                  1 });
+                    }
+                }
+                _capped_bands[band] = capped;
+            });
+
+        upload_dirty_tiles();
+    }
+
+    void GroundObject::upload_dirty_tiles()
+    {
+        const auto regions = _snow_height->take_dirty_regions();
+        _snow_height_texture->update_regions(*_snow_height, regions);
+    }
+
+    void GroundObject::request_snow_readback()
+    {
+        if (_simulation)
+        {
+            _readback_time = 0;
+            _simulation->request_readback();
+        }
+    }
+
+    GroundObject::AccumulationMode GroundObject::accumulation_mode() const
+    {
+        return _accumulation_mode;
+    }
+
+    bool GroundObject::receives_particles() const
+    {
+        return _deposition != nullptr;
+    }
+
+    std::shared_ptr<const HeightField> GroundObject::height_field() const
+    {
+        return _height_field;
+    }
+
+    size_t
+    GroundObject::land_particles(const ParticleView &view, IndexType *landed,
+                                 SnowDeposition::Accumulator &accumulator) const
+    {
+        // heights are looked up in blocks small enough for the stack
+        constexpr size_t BLOCK_SIZE = 256;
+        float heights[BLOCK_SIZE];
+        size_t landed_count = 0;
+        for (size_t begin = 0; begin < view.size; begin += BLOCK_SIZE)
         {
-            for (int x = 0; x < _snow_height.width(); ++x)
+            const auto count = std::min(BLOCK_SIZE, view.size - begin);
+            _height_field->heights(view.x + begin, view.y + begin, count,
+                                   heights);
+            for (size_t i = 0; i < count; ++i)
             {
-                auto height = _snow_height.at(y, x, 0);
-                height += accumulation;
-                height = std::min(height, _snow_mask.at(y, x, 0));
-                _snow_height.at(y, x, 0) = height;
+                const auto particle = begin + i;
+                if (view.z[particle] > heights[i])
+                {
+                    continue;
+                }
+                const auto ground =
+                    _projection->sample(view.x[particle], view.y[particle]);
+                if (ground)
+                {
+                    accumulator.deposit(ground->u, ground->v);
+                }
+                landed[landed_count++] = particle;
             }
         }
+        return landed_count;
+    }
 
-        _snow_height_texture->set_image(_snow_height, GL_RED, false);
+    SnowDeposition::Accumulator GroundObject::make_accumulator() const
+    {
+        return SnowDeposition::Accumulator(*_deposition);
+    }
+
+    void
+    GroundObject::deposit(std::span<SnowDeposition::Accumulator> accumulators)
+    {
+        _deposition->merge(accumulators, *_snow_height, *_snow_mask,
+                           *Engine::instance().job_system);
     }
 } // namespace pogl
@@ -1,12 +1,21 @@
 #pragma once
 
+#include <cstdint>
 #include <filesystem>
+#include <memory>
 #include <optional>
+#include <span>
+#include <vector>
 
-#include "image/image_buffer.hh"
+#include "ground_projection.hh"
+#include "height_field.hh"
+#include "image/height_map.hh"
 #include "mesh_renderer.hh"
+#include "particle_system/particle_storage.hh"
 #include "properties/drawable.hh"
 #include "properties/updateable.hh"
+#include "snow_deposition.hh"
+#include "snow_simulation.hh"
 
 namespace pogl
 {
@@ -18,6 +27,55 @@ namespace pogl
     {
     public:
         using RendererType = std::shared_ptr<MeshRenderer>;
+        using IndexType = std::uint32_t;
+
+        enum class AccumulationMode
+        {
+            /**
+             * @brief Every texel grows at the accumulation rate, on the CPU
+             * in parallel row bands
+             */
+            UNIFORM,
+            /**
+             * @brief Snow only grows where particles land, see
+             * land_particles
+             */
+            DEPOSITION,
+            /**
+             * @brief Every texel grows at the accumulation rate in the ground
+             * shader, from the `snow_time` uniform and the mask. The height
+             * map only holds what particles deposit on top of it, and is
+             * uploaded only where they changed it.
+             */
+            ANALYTIC,
+            /**
+             * @brief Every texel grows at the accumulation rate in a GPU
+             * pass, see SnowSimulation. There is no CPU height map, the
+             * height field reads copies requested every READBACK_INTERVAL.
+             */
+            GPU,
+        };
+
+        /**
+         * @brief Shape of the snow left by one landed flake
+         */
+        struct DepositionSettings
+        {
+            float peak_height;
+            int radius; // in texels of the snow height map
+        };
+
+        static constexpr auto DEFAULT_DEPOSITION =
+            DepositionSettings{ 0.05, 8 };
+        /**
+         * @brief World height of a snow height of 1
+         */
+        static constexpr float DEFAULT_DISPLACEMENT_SCALE = 0.5;
+        /**
+         * @brief Seconds between two copies of the GPU snow height to the
+         * height field
+         */
+        static constexpr float READBACK_INTERVAL = 0.25;
 
         class Builder
         {
@@ -32,6 +90,27 @@ namespace pogl
             Self &mask(fs::path snow_mask_path);
             Self &transform(const Matrix4 &transform);
             Self &accumulation_rate(float accumulation_rate);
+            Self &accumulation_mode(AccumulationMode mode);
+            Self &deposition(const DepositionSettings &settings);
+            /**
+             * @brief Sets the `scale` uniform of the shader, also used by the
+             * height field
+             */
+            Self &displacement_scale(float scale);
+            /**
+             * @brief Program of the GPU snow pass, required in GPU mode
+             */
+            Self &simulation_shader(ShaderType shader);
+            /**
+             * @brief Diffusion rate of the GPU snow pass, per second, see
+             * SnowSimulation
+             */
+            Self &diffusion(float diffusion);
+            /**
+             * @brief Precision of the snow height map and mask, on the CPU
+             * and in their textures
+             */
+            Self &precision(HeightMap::Precision precision);
 
             std::optional<BuildResult> build();
 
@@ -42,24 +121,125 @@ namespace pogl
             fs::path _snow_mask_path;
             Matrix4 _transform;
             float _accumulation_rate;
+            AccumulationMode _accumulation_mode;
+            DepositionSettings _deposition;
+            float _displacement_scale;
+            std::optional<ShaderType> _simulation_shader;
+            float _diffusion;
+            HeightMap::Precision _precision;
         };
 
         static Builder builder();
 
-        GroundObject(RendererType renderer, const FloatImageBuffer &snow_mask,
+        /**
+         * @param projection top view of the ground mesh, in world space, the
+         * ground has no height field and cannot receive particles without it
+         * @param mode
+         * @param accumulation_rate growth of the snow per second, unused in
+         * deposition mode
+         * @param deposition snow left by landed particles, unused in uniform
+         * mode
+         * @param displacement_scale
+         * @param simulation snow height pass, required in GPU mode only
+         */
+        GroundObject(RendererType renderer, const HeightMap &snow_mask,
                      std::shared_ptr<Texture> snow_height_texture,
-                     float accumulation_rate);
+                     std::shared_ptr<GroundProjection> projection,
+                     AccumulationMode mode, float accumulation_rate,
+                     const DepositionSettings &deposition = DEFAULT_DEPOSITION,
+                     float displacement_scale = DEFAULT_DISPLACEMENT_SCALE,
+                     std::shared_ptr<SnowSimulation> simulation = nullptr);
         virtual ~GroundObject() = default;
 
+        GroundObject(const GroundObject &) = delete;
+        GroundObject &operator=(const GroundObject &) = delete;
+
         virtual void draw() override;
         virtual void update(double delta) override;
 
+        AccumulationMode accumulation_mode() const;
+
+        /**
+         * @brief Whether particles can land on this ground, in deposition and
+         * analytic modes
+         *
+         * @return bool
+         */
+        bool receives_particles() const;
+
+        /**
+         * @brief Height of the snow covered ground, null without a
+         * projection. Reads the snow height map of this ground, which must
+         * outlive it.
+         *
+         * @return std::shared_ptr<const HeightField>
+         */
+        std::shared_ptr<const HeightField> height_field() const;
+
+        /**
+         * @brief Finds the particles of view under the ground and deposits
+         * them into accumulator. Safe to call from several threads with
+         * different accumulators.
+         *
+         * @param view
+         * @param landed output, indices relative to view in increasing order,
+         * must hold view.size elements
+         * @param accumulator
+         * @return size_t number of landed particles
+         */
+        size_t land_particles(const ParticleView &view, IndexType *landed,
+                              SnowDeposition::Accumulator &accumulator) const;
+
+        /**
+         * @brief Accumulator for land_particles, one per thread
+         *
+         * @return SnowDeposition::Accumulator
+         */
+        SnowDeposition::Accumulator make_accumulator() const;
+
+        /**
+         * @brief Adds the landed snow to the height map, the changed tiles
+         * are uploaded on the next update.
+         *
+         * @param accumulators
+         */
+        void deposit(std::span<SnowDeposition::Accumulator> accumulators);
+
+        /**
+         * @brief GPU mode, starts copying the snow height to the height
+         * field now rather than at the next READBACK_INTERVAL. The copy
+         * lands a few frames later.
+         */
+        void request_snow_readback();
+
     private:
+        /**
+         * @brief Uploads the tiles of the snow height map changed since the
+         * last call
+         */
+        void upload_dirty_tiles();
+
         RendererType _renderer;
-        FloatImageBuffer _snow_mask;
-        FloatImageBuffer _snow_height;
+        // shared with the height field
+        std::shared_ptr<HeightMap> _snow_mask;
+        // same precision as the mask, empty in GPU mode
+        std::shared_ptr<HeightMap> _snow_height;
         std::shared_ptr<Texture> _snow_height_texture;
         float _accumulation_rate;
+        AccumulationMode _accumulation_mode;
+        // uniform growth not yet added, below the step of the precision
+        float _pending_snow;
+        // seconds of analytic accumulation, stops once the mask is reached
+        float _snow_time;
+        float _full_snow_time;
+        std::optional<Uniform> _snow_time_uniform;
+        std::shared_ptr<GroundProjection> _projection;
+        std::shared_ptr<HeightField> _height_field;
+        std::unique_ptr<SnowDeposition> _deposition;
+        std::shared_ptr<SnowSimulation> _simulation;
+        float _readback_time;
+        // uniform mode, one flag per TILE_SIZE rows already at the mask
+        std::vector<std::uint8_t> _capped_bands;
     };
 
 } // namespace pogl
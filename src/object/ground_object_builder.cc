@@ -2,6 +2,7 @@
 
 #include "ground_object.hh"
 #include "import/importer.hh"
+#include "texture/texture.hh"
 #include "utils/log.hh"
 
 namespace pogl
@@ -14,6 +15,12 @@ namespace pogl
         , _snow_mask_path("../resources/ground/textures/snow_mask")
         , _transform(Matrix4::identity())
         , _accumulation_rate(0.05)
+        , _accumulation_mode(GroundObject::AccumulationMode::UNIFORM)
+        , _deposition(GroundObject::DEFAULT_DEPOSITION)
+        , _displacement_scale(GroundObject::DEFAULT_DISPLACEMENT_SCALE)
+        , _simulation_shader()
+        , _diffusion(0)
+        , _precision(HeightMap::Precision::FLOAT32)
     {}
 
     Self &Self::model(fs::path model_path)
@@ -41,6 +48,36 @@ namespace pogl
         _accumulation_rate = accumulation_rate;
         return *this;
     }
+    Self &Self::accumulation_mode(AccumulationMode mode)
+    {
+        _accumulation_mode = mode;
+        return *this;
+    }
+    Self &Self::deposition(const DepositionSettings &settings)
+    {
+        _deposition = settings;
+        return *this;
+    }
+    Self &Self::displacement_scale(float scale)
+    {
+        _displacement_scale = scale;
+        return *this;
+    }
+    Self &Self::simulation_shader(ShaderType shader)
+    {
+        _simulation_shader = shader;
+        return *this;
+    }
+    Self &Self::diffusion(float diffusion)
+    {
+        _diffusion = diffusion;
+        return *this;
+    }
+    Self &Self::precision(HeightMap::Precision precision)
+    {
+        _precision = precision;
+        return *this;
+    }
     void Self::assert_integrity()
     {
         bool error = false;
@@ -50,6 +87,12 @@ namespace pogl
                       << "Cannot build ground, shader is missing.\n";
             error = true;
         }
+        if (_accumulation_mode == AccumulationMode::GPU && !_simulation_shader)
+        {
+            std::cerr << LOG_ERROR << "Cannot build ground, GPU accumulation "
+                                      "needs a simulation shader.\n";
+            error = true;
+        }
         if (error)
         {
             throw std::logic_error("Cannot build ground object, see stderr.");
@@ -93,9 +136,34 @@ namespace pogl
                             .add_attribute("vNormal", 3, 2)
                             .transform(_transform)
                             .build();
+        auto scale_u = (*_shader)->uniform("scale");
+        if (scale_u)
+            scale_u->set_float(_displacement_scale);
+        auto snow_height_texture =
+            (*_shader)->get_texture_by_name("snow_height").value();
+        auto projection = std::make_shared<GroundProjection>(
+            ground_buffers.at("position"), ground_buffers.at("uv"),
+            _transform);
+        // only the first channel is used, at the precision of the heights
+        const auto mask = HeightMap::from_image(*snow_mask, _precision);
+        // the shader caps the snow by the mask in every mode
+        auto snow_mask_texture = Texture::builder()
+                                     .buffer(mask)
+                                     .wrap(GL_CLAMP_TO_EDGE)
+                                     .format(mask.internal_format())
+                                     .min_filter(GL_LINEAR)
+                                     .build();
+        (*_shader)->set_texture("snow_mask", snow_mask_texture);
+        std::shared_ptr<SnowSimulation> simulation = nullptr;
+        if (_accumulation_mode == AccumulationMode::GPU)
+        {
+            simulation = std::make_shared<SnowSimulation>(
+                *_simulation_shader, snow_mask_texture, mask.width(),
+                mask.height(), _diffusion);
+        }
         return std::make_shared<GroundObject>(
-            renderer, *snow_mask,
-            (*_shader)->get_texture_by_name("snow_height").value(),
-            _accumulation_rate);
+            renderer, mask, snow_height_texture, projection,
+            _accumulation_mode, _accumulation_rate, _deposition,
+            _displacement_scale, simulation);
     }
 } // namespace pogl
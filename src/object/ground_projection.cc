@@ -0,0 +1,187 @@
+#include "ground_projection.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace pogl
+{
+    namespace
+    {
+        constexpr float NO_GROUND = -std::numeric_limits<float>::infinity();
+        // cells exactly on a shared edge belong to both triangles
+        constexpr float EDGE_TOLERANCE = -1e-6;
+
+        float transform_coordinate(const Matrix4 &transform, size_t row,
+                                   const GLfloat *position)
+        {
+            return transform.at(0, row) * position[0]
+                + transform.at(1, row) * position[1]
+                + transform.at(2, row) * position[2] + transform.at(3, row);
+        }
+    } // namespace
+
+    GroundProjection::GroundProjection(std::span<const GLfloat> positions,
+                                       std::span<const GLfloat> uvs,
+                                       const Matrix4 &transform,
+                                       int resolution)
+        : _resolution(resolution)
+        , _min_x(0)
+        , _min_y(0)
+        , _cell_width(1)
+        , _cell_height(1)
+        , _cells(resolution * resolution, Sample{ NO_GROUND, 0, 0 })
+    {
+        const auto vertex_count = std::min(positions.size() / 3, uvs.size() / 2);
+        auto world = std::vector<GLfloat>(vertex_count * 3);
+        for (size_t i = 0; i < vertex_count; ++i)
+        {
+            for (size_t axis = 0; axis < 3; ++axis)
+            {
+                world[i * 3 + axis] =
+                    transform_coordinate(transform, axis, &positions[i * 3]);
+            }
+        }
+        if (vertex_count == 0)
+        {
+            return;
+        }
+
+        auto max_x = world[0];
+        auto max_y = world[1];
+        _min_x = max_x;
+        _min_y = max_y;
+        for (size_t i = 1; i < vertex_count; ++i)
+        {
+            _min_x = std::min(_min_x, world[i * 3]);
+            max_x = std::max(max_x, world[i * 3]);
+            _min_y = std::min(_min_y, world[i * 3 + 1]);
+            max_y = std::max(max_y, world[i * 3 + 1]);
+        }
+        _cell_width = std::max(max_x - _min_x, 1e-6f) / _resolution;
+        _cell_height = std::max(max_y - _min_y, 1e-6f) / _resolution;
+
+        for (size_t first = 0; first + 3 <= vertex_count; first += 3)
+        {
+            float x[3], y[3], z[3], u[3], v[3];
+            for (size_t corner = 0; corner < 3; ++corner)
+            {
+                const auto i = first + corner;
+                x[corner] = world[i * 3];
+                y[corner] = world[i * 3 + 1];
+                z[corner] = world[i * 3 + 2];
+                u[corner] = uvs[i * 2];
+                v[corner] = uvs[i * 2 + 1];
+            }
+            rasterize(x, y, z, u, v);
+        }
+    }
+
+    void GroundProjection::rasterize(const float (&x)[3], const float (&y)[3],
+                                     const float (&z)[3], const float (&u)[3],
+                                     const float (&v)[3])
+    {
+        const auto area =
+            (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+        // vertical faces are invisible from above
+        if (std::abs(area) < 1e-12f)
+        {
+            return;
+        }
+
+        const auto to_cell_x = [this](float value) {
+            return (value - _min_x) / _cell_width - 0.5f;
+        };
+        const auto to_cell_y = [this](float value) {
+            return (value - _min_y) / _cell_height - 0.5f;
+        };
+        const auto first_col = std::max(
+            0, (int)std::ceil(to_cell_x(std::min({ x[0], x[1], x[2] }))));
+        const auto last_col =
+            std::min(_resolution - 1,
+                     (int)std::floor(to_cell_x(std::max({ x[0], x[1], x[2] }))));
+        const auto first_row = std::max(
+            0, (int)std::ceil(to_cell_y(std::min({ y[0], y[1], y[2] }))));
+        const auto last_row =
+            std::min(_resolution - 1,
+                     (int)std::floor(to_cell_y(std::max({ y[0], y[1], y[2] }))));
+
+        for (int row = first_row; row <= last_row; ++row)
+        {
+            const auto py = _min_y + (row + 0.5f) * _cell_height;
+            for (int col = first_col; col <= last_col; ++col)
+            {
+                const auto px = _min_x + (col + 0.5f) * _cell_width;
+                // barycentric coordinates of the cell center
+                const auto w0 = ((x[1] - px) * (y[2] - py)
+                                 - (x[2] - px) * (y[1] - py))
+                    / area;
+                const auto w1 = ((x[2] - px) * (y[0] - py)
+                                 - (x[0] - px) * (y[2] - py))
+                    / area;
+                const auto w2 = 1 - w0 - w1;
+                if (w0 < EDGE_TOLERANCE || w1 < EDGE_TOLERANCE
+                    || w2 < EDGE_TOLERANCE)
+                {
+                    continue;
+                }
+
+                const auto height = w0 * z[0] + w1 * z[1] + w2 * z[2];
+                auto &cell = _cells[row * _resolution + col];
+                if (height > cell.height)
+                {
+                    cell = Sample{ height, w0 * u[0] + w1 * u[1] + w2 * u[2],
+                                   w0 * v[0] + w1 * v[1] + w2 * v[2] };
+                }
+            }
+        }
+    }
+
+    std::optional<GroundProjection::Sample>
+    GroundProjection::sample(float x, float y) const
+    {
+        const auto col = (int)std::floor((x - _min_x) / _cell_width);
+        const auto row = (int)std::floor((y - _min_y) / _cell_height);
+        if (col < 0 || row < 0 || col >= _resolution || row >= _resolution)
+        {
+            return std::nullopt;
+        }
+        const auto &cell = _cells[row * _resolution + col];
+        if (cell.height == NO_GROUND)
+        {
+            return std::nullopt;
+        }
+        return cell;
+    }
+
+    int GroundProjection::resolution() const
+    {
+        return _resolution;
+    }
+
+    float GroundProjection::min_x() const
+    {
+        return _min_x;
+    }
+
+    float GroundProjection::min_y() const
+    {
+        return _min_y;
+    }
+
+    float GroundProjection::cell_width() const
+    {
+        return _cell_width;
+    }
+
+    float GroundProjection::cell_height() const
+    {
+        return _cell_height;
+    }
+
+    const std::vector<GroundProjection::Sample> &
+    GroundProjection::cells() const
+    {
+        return _cells;
+    }
+} // namespace pogl
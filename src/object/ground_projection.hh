@@ -0,0 +1,82 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "matrix4/matrix4.hh"
+
+namespace pogl
+{
+    /**
+     * @brief Top view of a triangle mesh: a regular grid over the world xy
+     * bounds of the mesh, holding for every cell the height and texture
+     * coordinates of the highest surface above its center.
+     *
+     * Turns a world position into the texel of a texture mapped on the mesh,
+     * whatever its UV unwrap.
+     */
+    class GroundProjection
+    {
+    public:
+        static constexpr int DEFAULT_RESOLUTION = 512;
+
+        struct Sample
+        {
+            float height;
+            float u;
+            float v;
+        };
+
+        /**
+         * @brief Rasterises the triangles of the mesh.
+         *
+         * @param positions three floats per vertex, three vertices per
+         * triangle
+         * @param uvs two floats per vertex
+         * @param transform model transform of the mesh
+         * @param resolution number of cells along each axis
+         */
+        GroundProjection(std::span<const GLfloat> positions,
+                         std::span<const GLfloat> uvs,
+                         const Matrix4 &transform,
+                         int resolution = DEFAULT_RESOLUTION);
+
+        /**
+         * @brief Surface under (x, y), nothing outside of the mesh
+         *
+         * @param x
+         * @param y
+         * @return std::optional<Sample>
+         */
+        std::optional<Sample> sample(float x, float y) const;
+
+        int resolution() const;
+        float min_x() const;
+        float min_y() const;
+        float cell_width() const;
+        float cell_height() const;
+
+        /**
+         * @brief Cells in row major order, the center of cell (row, col) is
+         * at min + (col + 0.5, row + 0.5) * cell size
+         *
+         * @return const std::vector<Sample>&
+         */
+        const std::vector<Sample> &cells() const;
+
+    private:
+        void rasterize(const float (&x)[3], const float (&y)[3],
+                       const float (&z)[3], const float (&u)[3],
+                       const float (&v)[3]);
+
+        int _resolution;
+        float _min_x;
+        float _min_y;
+        float _cell_width;
+        float _cell_height;
+        // row major, height is -infinity where no triangle covers the cell
+        std::vector<Sample> _cells;
+    };
+} // namespace pogl
@@ -0,0 +1,206 @@
+#include "height_field.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#include "utils/cpu_features.hh"
+#include "utils/log.hh"
+
+namespace pogl
+{
+    namespace
+    {
+        constexpr float NO_GROUND = -std::numeric_limits<float>::infinity();
+    } // namespace
+
+    HeightField::HeightField(const GroundProjection &projection,
+                             std::shared_ptr<const HeightMap> snow_height,
+                             std::shared_ptr<const HeightMap> snow_mask,
+                             float snow_scale)
+        : _resolution(projection.resolution())
+        , _min_x(projection.min_x())
+        , _min_y(projection.min_y())
+        , _cell_width(projection.cell_width())
+        , _cell_height(projection.cell_height())
+        , _ground(projection.cells().size())
+        , _snow_offsets(projection.cells().size())
+        , _snow_height(std::move(snow_height))
+        , _snow_mask(std::move(snow_mask))
+        , _snow_level(0)
+        , _snow_scale(snow_scale)
+    {
+        if (_resolution < 2 || !_snow_height || !_snow_mask
+            || _snow_height->empty()
+            || _snow_mask->width() != _snow_height->width()
+            || _snow_mask->height() != _snow_height->height())
+        {
+            std::cerr << LOG_ERROR
+                      << "height field needs at least 2x2 cells and a snow "
+                         "height map the size of its mask, got "
+                      << _resolution << " cells per axis" << std::endl;
+            throw std::logic_error("Invalid height field");
+        }
+
+        // the snow texel under every cell is fixed, only its value changes
+        const auto width = _snow_height->width();
+        const auto height = _snow_height->height();
+        const auto &cells = projection.cells();
+        for (size_t i = 0; i < cells.size(); ++i)
+        {
+            const auto &cell = cells[i];
+            _ground[i] = cell.height;
+            if (cell.height == NO_GROUND)
+            {
+                _snow_offsets[i] = 0;
+                continue;
+            }
+            const auto col = std::clamp((int)(cell.u * width), 0, width - 1);
+            const auto row = std::clamp((int)(cell.v * height), 0, height - 1);
+            _snow_offsets[i] = row * width + col;
+        }
+    }
+
+    void HeightField::set_snow_level(float level)
+    {
+        _snow_level = level;
+    }
+
+    void HeightField::heights(const float *x, const float *y, size_t count,
+                              float *heights) const
+    {
+        sample(x, y, count, heights, nullptr, nullptr, nullptr);
+    }
+
+    void HeightField::normals(const float *x, const float *y, size_t count,
+                              float *nx, float *ny, float *nz) const
+    {
+        sample(x, y, count, nullptr, nx, ny, nz);
+    }
+
+    float HeightField::height(float x, float y) const
+    {
+        float result;
+        kernels::sample_height_field_scalar(grid(), &x, &y, 0, 1, &result,
+                                            nullptr, nullptr, nullptr);
+        return result;
+    }
+
+    Vector3 HeightField::normal(float x, float y) const
+    {
+        float nx, ny, nz;
+        kernels::sample_height_field_scalar(grid(), &x, &y, 0, 1, nullptr,
+                                            &nx, &ny, &nz);
+        return Vector3(nx, ny, nz);
+    }
+
+    void HeightField::sample(const float *x, const float *y, size_t count,
+                             float *heights, float *nx, float *ny,
+                             float *nz) const
+    {
+        const auto field = grid();
+#if defined(__x86_64__) || defined(__i386__)
+        if (cpu_features().avx2
+            && kernels::gathers_precision(field.snow_precision)
+            && kernels::gathers_precision(field.mask_precision))
+        {
+            kernels::sample_height_field_avx2(field, x, y, count, heights, nx,
+                                              ny, nz);
+            return;
+        }
+#endif
+        kernels::sample_height_field_scalar(field, x, y, 0, count, heights,
+                                            nx, ny, nz);
+    }
+
+    HeightField::Grid HeightField::grid() const
+    {
+        return Grid{
+            _resolution,
+            _min_x,
+            _min_y,
+            1 / _cell_width,
+            1 / _cell_height,
+            _ground.data(),
+            _snow_offsets.data(),
+            _snow_height->data(),
+            _snow_height->precision(),
+            _snow_mask->data(),
+            _snow_mask->precision(),
+            _snow_level,
+            _snow_scale,
+        };
+    }
+
+    namespace kernels
+    {
+        void sample_height_field_scalar(const HeightField::Grid &grid,
+                                        const float *x, const float *y,
+                                        size_t begin, size_t end,
+                                        float *heights, float *nx, float *ny,
+                                        float *nz)
+        {
+            const auto upper = grid.resolution - 0.5f;
+            const auto last_cell = (float)(grid.resolution - 1);
+            const auto surface = [&grid](int cell) {
+                const auto offset = grid.snow_offsets[cell];
+                const auto snow = std::min(
+                    HeightMap::decode(grid.mask, grid.mask_precision, offset),
+                    grid.snow_level
+                        + HeightMap::decode(grid.snow, grid.snow_precision,
+                                            offset));
+                return grid.ground[cell] + grid.snow_scale * snow;
+            };
+
+            for (size_t i = begin; i < end; ++i)
+            {
+                // in cells, cell centers are at integers
+                const auto fx =
+                    (x[i] - grid.min_x) * grid.inverse_cell_width - 0.5f;
+                const auto fy =
+                    (y[i] - grid.min_y) * grid.inverse_cell_height - 0.5f;
+                const bool inside = fx >= -0.5f && fx <= upper
+                    && fy >= -0.5f && fy <= upper;
+                // max first so that NaN clamps to 0
+                const auto cx = std::min(std::max(0.f, fx), last_cell);
+                const auto cy = std::min(std::max(0.f, fy), last_cell);
+                const auto col =
+                    std::min((int)std::floor(cx), grid.resolution - 2);
+                const auto row =
+                    std::min((int)std::floor(cy), grid.resolution - 2);
+                const auto tx = cx - col;
+                const auto ty = cy - row;
+
+                const auto cell = row * grid.resolution + col;
+                const auto h00 = surface(cell);
+                const auto h10 = surface(cell + 1);
+                const auto h01 = surface(cell + grid.resolution);
+                const auto h11 = surface(cell + grid.resolution + 1);
+                const bool valid = inside && h00 > NO_GROUND
+                    && h10 > NO_GROUND && h01 > NO_GROUND && h11 > NO_GROUND;
+
+                const auto h0 = h00 + tx * (h10 - h00);
+                const auto h1 = h01 + tx * (h11 - h01);
+                if (heights != nullptr)
+                {
+                    heights[i] = valid ? h0 + ty * (h1 - h0) : NO_GROUND;
+                }
+                if (nx != nullptr)
+                {
+                    const auto dx0 = h10 - h00;
+                    const auto dx1 = h11 - h01;
+                    const auto dhdx =
+                        (dx0 + ty * (dx1 - dx0)) * grid.inverse_cell_width;
+                    const auto dhdy = (h1 - h0) * grid.inverse_cell_height;
+                    const auto length =
+                        std::sqrt(dhdx * dhdx + dhdy * dhdy + 1.f);
+                    nx[i] = valid ? -dhdx / length : 0.f;
+                    ny[i] = valid ? -dhdy / length : 0.f;
+                    nz[i] = valid ? 1.f / length : 1.f;
+                }
+            }
+        }
+    } // namespace kernels
+} // namespace pogl
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "ground_projection.hh"
+#include "image/height_map.hh"
+#include "vector3/vector3.hh"
+
+namespace pogl
+{
+    /**
+     * @brief Height of the snow covered ground at world positions.
+     *
+     * Combines the top view of the ground mesh with its snow, displaced along
+     * the world up axis like the ground shader does: the snow height map plus
+     * a uniform snow level, capped by the snow mask. Heights are bilinearly
+     * interpolated between cell centers, positions off the ground read as
+     * -infinity.
+     *
+     * The snow height map and mask are read at query time, the field shares
+     * their ownership so that it may outlive the ground they come from.
+     */
+    class HeightField
+    {
+    public:
+        /**
+         * @brief Flat view of the field read by the kernels
+         */
+        struct Grid
+        {
+            int resolution;
+            float min_x;
+            float min_y;
+            float inverse_cell_width;
+            float inverse_cell_height;
+            const float *ground; // -infinity off the mesh
+            const std::int32_t *snow_offsets; // in texels, one per cell
+            const std::byte *snow;
+            HeightMap::Precision snow_precision;
+            const std::byte *mask; // same size as snow
+            HeightMap::Precision mask_precision;
+            float snow_level;
+            float snow_scale;
+        };
+
+        /**
+         * @param projection top view of the ground mesh, in world space
+         * @param snow_height height map mapped on the mesh UVs
+         * @param snow_mask highest snow height of every texel of snow_height,
+         * of any precision
+         * @param snow_scale world height of a snow value of 1, the
+         * displacement scale of the ground shader
+         */
+        HeightField(const GroundProjection &projection,
+                    std::shared_ptr<const HeightMap> snow_height,
+                    std::shared_ptr<const HeightMap> snow_mask,
+                    float snow_scale);
+
+        /**
+         * @brief Snow height added everywhere on top of the height map, 0 by
+         * default
+         *
+         * @param level
+         */
+        void set_snow_level(float level);
+
+        /**
+         * @brief Surface height under count positions
+         *
+         * @param x
+         * @param y
+         * @param count
+         * @param heights output, -infinity off the ground
+         */
+        void heights(const float *x, const float *y, size_t count,
+                     float *heights) const;
+
+        /**
+         * @brief Surface normals under count positions, straight up off the
+         * ground
+         *
+         * @param x
+         * @param y
+         * @param count
+         * @param nx output
+         * @param ny output
+         * @param nz output
+         */
+        void normals(const float *x, const float *y, size_t count, float *nx,
+                     float *ny, float *nz) const;
+
+        float height(float x, float y) const;
+        Vector3 normal(float x, float y) const;
+
+    private:
+        void sample(const float *x, const float *y, size_t count,
+                    float *heights, float *nx, float *ny, float *nz) const;
+        Grid grid() const;
+
+        int _resolution;
+        float _min_x;
+        float _min_y;
+        float _cell_width;
+        float _cell_height;
+        std::vector<float> _ground;
+        std::vector<std::int32_t> _snow_offsets;
+        std::shared_ptr<const HeightMap> _snow_height;
+        std::shared_ptr<const HeightMap> _snow_mask;
+        float _snow_level;
+        float _snow_scale;
+    };
+
+    namespace kernels
+    {
+        // heights or normals may be null when not needed
+        void sample_height_field_scalar(const HeightField::Grid &grid,
+                                        const float *x, const float *y,
+                                        size_t begin, size_t end,
+                                        float *heights, float *nx, float *ny,
+                                        float *nz);
+        // precisions the AVX2 kernel reads, float32 and unorm16
+        inline bool gathers_precision(HeightMap::Precision precision)
+        {
+            return precision == HeightMap::Precision::FLOAT32
+                || precision == HeightMap::Precision::UNORM16;
+        }
+
+        // snow and mask of a gathers_precision precision only
+        void sample_height_field_avx2(const HeightField::Grid &grid,
+                                      const float *x, const float *y,
+                                      size_t count, float *heights, float *nx,
+                                      float *ny, float *nz);
+    } // namespace kernels
+} // namespace pogl
@@ -0,0 +1,163 @@
+#include "height_field.hh"
+
+#if defined(__x86_64__) || defined(__i386__)
+#    include <immintrin.h>
+#    include <limits>
+
+namespace pogl::kernels
+{
+    // Eight positions at a time, the four corner heights of their cells are
+    // gathered from the ground and the float32 or unorm16 snow maps. Same
+    // operations in the same order as the scalar kernel, so both give the
+    // same values.
+
+    namespace
+    {
+        // 16-bit texels are gathered as 32-bit words starting at the texel,
+        // the high half belongs to the next texel or to the padding of the
+        // map. Converting then scaling is exact like the scalar decoding.
+        __attribute__((target("avx2"))) inline __m256
+        gather_map_avx2(const std::byte *texels, HeightMap::Precision precision,
+                        __m256i offsets)
+        {
+            if (precision == HeightMap::Precision::UNORM16)
+            {
+                const auto words = _mm256_i32gather_epi32(
+                    reinterpret_cast<const int *>(texels), offsets, 2);
+                const auto values =
+                    _mm256_and_si256(words, _mm256_set1_epi32(0xffff));
+                return _mm256_mul_ps(_mm256_cvtepi32_ps(values),
+                                     _mm256_set1_ps(1.f / 65535));
+            }
+            return _mm256_i32gather_ps(reinterpret_cast<const float *>(texels),
+                                       offsets, 4);
+        }
+
+        __attribute__((target("avx2"))) inline __m256
+        surface_avx2(const HeightField::Grid &grid, __m256i cell)
+        {
+            const auto ground = _mm256_i32gather_ps(grid.ground, cell, 4);
+            const auto offsets = _mm256_i32gather_epi32(
+                reinterpret_cast<const int *>(grid.snow_offsets), cell, 4);
+            const auto snow = _mm256_min_ps(
+                gather_map_avx2(grid.mask, grid.mask_precision, offsets),
+                _mm256_add_ps(
+                    _mm256_set1_ps(grid.snow_level),
+                    gather_map_avx2(grid.snow, grid.snow_precision, offsets)));
+            return _mm256_add_ps(
+                ground, _mm256_mul_ps(_mm256_set1_ps(grid.snow_scale), snow));
+        }
+    } // namespace
+
+    __attribute__((target("avx2"))) void
+    sample_height_field_avx2(const HeightField::Grid &grid, const float *x,
+                             const float *y, size_t count, float *heights,
+                             float *nx, float *ny, float *nz)
+    {
+        constexpr size_t LANES = 8;
+        const auto min_x = _mm256_set1_ps(grid.min_x);
+        const auto min_y = _mm256_set1_ps(grid.min_y);
+        const auto inverse_width = _mm256_set1_ps(grid.inverse_cell_width);
+        const auto inverse_height = _mm256_set1_ps(grid.inverse_cell_height);
+        const auto half = _mm256_set1_ps(0.5f);
+        const auto lower = _mm256_set1_ps(-0.5f);
+        const auto upper = _mm256_set1_ps(grid.resolution - 0.5f);
+        const auto last_cell = _mm256_set1_ps((float)(grid.resolution - 1));
+        const auto last_index = _mm256_set1_epi32(grid.resolution - 2);
+        const auto resolution = _mm256_set1_epi32(grid.resolution);
+        const auto zero = _mm256_setzero_ps();
+        const auto one = _mm256_set1_ps(1.f);
+        const auto sign = _mm256_set1_ps(-0.f);
+        const auto no_ground =
+            _mm256_set1_ps(-std::numeric_limits<float>::infinity());
+
+        size_t i = 0;
+        for (; i + LANES <= count; i += LANES)
+        {
+            const auto fx = _mm256_sub_ps(
+                _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(x + i), min_x),
+                              inverse_width),
+                half);
+            const auto fy = _mm256_sub_ps(
+                _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(y + i), min_y),
+                              inverse_height),
+                half);
+            auto valid = _mm256_and_ps(_mm256_cmp_ps(fx, lower, _CMP_GE_OQ),
+                                       _mm256_cmp_ps(fx, upper, _CMP_LE_OQ));
+            valid = _mm256_and_ps(valid, _mm256_cmp_ps(fy, lower, _CMP_GE_OQ));
+            valid = _mm256_and_ps(valid, _mm256_cmp_ps(fy, upper, _CMP_LE_OQ));
+
+            // max returns its second operand for NaN
+            const auto cx =
+                _mm256_min_ps(_mm256_max_ps(fx, zero), last_cell);
+            const auto cy =
+                _mm256_min_ps(_mm256_max_ps(fy, zero), last_cell);
+            const auto col = _mm256_min_epi32(
+                _mm256_cvttps_epi32(_mm256_floor_ps(cx)), last_index);
+            const auto row = _mm256_min_epi32(
+                _mm256_cvttps_epi32(_mm256_floor_ps(cy)), last_index);
+            const auto tx = _mm256_sub_ps(cx, _mm256_cvtepi32_ps(col));
+            const auto ty = _mm256_sub_ps(cy, _mm256_cvtepi32_ps(row));
+
+            const auto cell =
+                _mm256_add_epi32(_mm256_mullo_epi32(row, resolution), col);
+            const auto next_row = _mm256_add_epi32(cell, resolution);
+            const auto right = _mm256_set1_epi32(1);
+            const auto h00 = surface_avx2(grid, cell);
+            const auto h10 =
+                surface_avx2(grid, _mm256_add_epi32(cell, right));
+            const auto h01 = surface_avx2(grid, next_row);
+            const auto h11 =
+                surface_avx2(grid, _mm256_add_epi32(next_row, right));
+            valid = _mm256_and_ps(valid,
+                                  _mm256_cmp_ps(h00, no_ground, _CMP_GT_OQ));
+            valid = _mm256_and_ps(valid,
+                                  _mm256_cmp_ps(h10, no_ground, _CMP_GT_OQ));
+            valid = _mm256_and_ps(valid,
+                                  _mm256_cmp_ps(h01, no_ground, _CMP_GT_OQ));
+            valid = _mm256_and_ps(valid,
+                                  _mm256_cmp_ps(h11, no_ground, _CMP_GT_OQ));
+
+            const auto h0 = _mm256_add_ps(
+                h00, _mm256_mul_ps(tx, _mm256_sub_ps(h10, h00)));
+            const auto h1 = _mm256_add_ps(
+                h01, _mm256_mul_ps(tx, _mm256_sub_ps(h11, h01)));
+            if (heights != nullptr)
+            {
+                const auto h = _mm256_add_ps(
+                    h0, _mm256_mul_ps(ty, _mm256_sub_ps(h1, h0)));
+                _mm256_storeu_ps(heights + i,
+                                 _mm256_blendv_ps(no_ground, h, valid));
+            }
+            if (nx != nullptr)
+            {
+                const auto dx0 = _mm256_sub_ps(h10, h00);
+                const auto dx1 = _mm256_sub_ps(h11, h01);
+                const auto dhdx = _mm256_mul_ps(
+                    _mm256_add_ps(dx0,
+                                  _mm256_mul_ps(ty, _mm256_sub_ps(dx1, dx0))),
+                    inverse_width);
+                const auto dhdy =
+                    _mm256_mul_ps(_mm256_sub_ps(h1, h0), inverse_height);
+                const auto length = _mm256_sqrt_ps(_mm256_add_ps(
+                    _mm256_add_ps(_mm256_mul_ps(dhdx, dhdx),
+                                  _mm256_mul_ps(dhdy, dhdy)),
+                    one));
+                const auto normal_x =
+                    _mm256_div_ps(_mm256_xor_ps(dhdx, sign), length);
+                const auto normal_y =
+                    _mm256_div_ps(_mm256_xor_ps(dhdy, sign), length);
+                _mm256_storeu_ps(nx + i,
+                                 _mm256_blendv_ps(zero, normal_x, valid));
+                _mm256_storeu_ps(ny + i,
+                                 _mm256_blendv_ps(zero, normal_y, valid));
+                _mm256_storeu_ps(
+                    nz + i,
+                    _mm256_blendv_ps(one, _mm256_div_ps(one, length), valid));
+            }
+        }
+        sample_height_field_scalar(grid, x, y, i, count, heights, nx, ny, nz);
+    }
+} // namespace pogl::kernels
+
+#endif // x86
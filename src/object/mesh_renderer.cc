@@ -1,5 +1,7 @@
 #include "mesh_renderer.hh"
 
+#include <utility>
+
 #include "utils/definitions.hh"
 #include "utils/gl_check.hh"
 
@@ -11,21 +13,21 @@ namespace pogl
     MeshRenderer::MeshRenderer(VaoType vao_id, DrawModeType draw_mode,
                                const ShaderType &shader,
                                size_t vertex_count,
-                               std::vector<GLuint> buffer_ids,
+                               GpuBufferCollectionType buffers,
                                const Matrix4 &transform,
                                UniformType transform_uniform)
         : _shader(shader)
         , _vao_id(vao_id)
         , _draw_mode(draw_mode)
         , _vertex_count(vertex_count)
-        , _buffer_ids(buffer_ids)
+        , _buffers(std::move(buffers))
         , _transform(transform)
         , _transform_uniform(transform_uniform)
     {}
 
     MeshRenderer::~MeshRenderer()
     {
-        glDeleteBuffers(_buffer_ids.size(), _buffer_ids.data());
+        // the buffers delete themselves
         glDeleteVertexArrays(1, &_vao_id);
     }
 
@@ -58,4 +60,9 @@ namespace pogl
     {
         return _shader;
     }
+
+    Buffer &MeshRenderer::buffer(size_t i)
+    {
+        return _buffers.at(i);
+    }
 } // namespace pogl
@@ -7,6 +7,7 @@
 #include <tuple>
 #include <vector>
 
+#include "buffer/buffer.hh"
 #include "properties/drawable.hh"
 #include "shader_program/shader_program.hh"
 
@@ -18,6 +19,7 @@ namespace pogl
         using ShaderType = std::shared_ptr<ShaderProgram>;
         using VaoType = GLuint;
         using BufferType = std::vector<GLfloat>;
+        using GpuBufferCollectionType = std::vector<Buffer>;
         using DrawModeType = GLenum;
         using UniformType = std::optional<Uniform>;
         using Self = MeshRenderer;
@@ -53,7 +55,7 @@ namespace pogl
 
         MeshRenderer(VaoType vao_id, DrawModeType draw_mode,
                      const ShaderType &shader, size_t vertex_count,
-                     std::vector<GLuint> _buffer_ids, const Matrix4 &transform,
+                     GpuBufferCollectionType buffers, const Matrix4 &transform,
                      UniformType transform_uniform);
         virtual ~MeshRenderer();
 
@@ -65,12 +67,20 @@ namespace pogl
 
         ShaderType shader();
 
+        /**
+         * @brief Vertex buffer i, in the order they were added to the builder
+         *
+         * @param i
+         * @return Buffer&
+         */
+        Buffer &buffer(size_t i);
+
     private:
         ShaderType _shader;
         VaoType _vao_id;
         DrawModeType _draw_mode;
         size_t _vertex_count;
-        std::vector<GLuint> _buffer_ids;
+        GpuBufferCollectionType _buffers;
         Matrix4 _transform;
         UniformType _transform_uniform;
     };
@@ -1,4 +1,6 @@
 #include <iostream>
+#include <span>
+#include <utility>
 
 #include "mesh_renderer.hh"
 #include "utils/buffer_offset_macro.hh"
@@ -128,18 +130,13 @@ namespace pogl
         glBindVertexArray(vao_id);
         CHECK_GL_ERROR();
 
-        auto buffer_ids = std::vector<GLuint>(_buffers.size());
-
-        glGenBuffers(_buffers.size(), buffer_ids.data());
-        CHECK_GL_ERROR();
-        std::vector<size_t> strides(buffer_ids.size());
-        for (size_t i = 0; i < buffer_ids.size(); ++i)
+        auto buffers = GpuBufferCollectionType();
+        buffers.reserve(_buffers.size());
+        std::vector<size_t> strides(_buffers.size());
+        for (size_t i = 0; i < _buffers.size(); ++i)
         {
-            glBindBuffer(GL_ARRAY_BUFFER, buffer_ids[i]);
-            CHECK_GL_ERROR();
-            glBufferData(GL_ARRAY_BUFFER, _buffers[i].size() * sizeof(GLfloat),
-                         _buffers[i].data(), GL_STATIC_DRAW);
-            CHECK_GL_ERROR();
+            auto &buffer = buffers.emplace_back(GL_ARRAY_BUFFER);
+            buffer.set_data(std::span<const GLfloat>(_buffers[i]));
             size_t stride = 0;
             for (auto [_, size] : _attribute_config.at(i))
             {
@@ -159,10 +156,11 @@ namespace pogl
                 }
                 glVertexAttribPointer(location, size, GL_FLOAT, GL_FALSE,
                                       stride * sizeof(GLfloat),
-                                      BUFFER_OFFSET(offset));
+                                      BUFFER_OFFSET(offset * sizeof(GLfloat)));
                 CHECK_GL_ERROR();
                 glEnableVertexAttribArray(location);
                 CHECK_GL_ERROR();
+                offset += size;
             }
         }
         glBindBuffer(GL_ARRAY_BUFFER, 0);
@@ -173,7 +171,7 @@ namespace pogl
 
         return std::make_shared<MeshRenderer>(
             vao_id, _draw_mode, *_shader, _buffers[0].size() / strides[0],
-            buffer_ids, _transform,
+            std::move(buffers), _transform,
             (*_shader)->uniform(definitions::MODEL_TRANSFORM_UNIFORM_NAME));
     }
 
@@ -0,0 +1,168 @@
+#include "snow_accumulation.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "utils/cpu_features.hh"
+#include "utils/half.hh"
+
+namespace pogl
+{
+    namespace
+    {
+        template <typename T>
+        T unorm_steps(float amount)
+        {
+            constexpr auto MAX = (float)std::numeric_limits<T>::max();
+            return (T)std::lround(std::clamp(amount * MAX, 0.f, MAX));
+        }
+
+        template <typename T>
+        void accumulate_unorm(T *heights, const T *mask, size_t begin,
+                              size_t end, T steps, AccumulationSpan &span)
+        {
+            constexpr auto MAX = std::numeric_limits<T>::max();
+            for (size_t i = begin; i < end; ++i)
+            {
+                const auto previous = heights[i];
+                // saturating add, like the SIMD kernels
+                const auto sum =
+                    previous > MAX - steps ? MAX : (T)(previous + steps);
+                const auto height = std::min(sum, mask[i]);
+                heights[i] = height;
+                if (height != previous)
+                {
+                    span.first = std::min(span.first, i);
+                    span.end = i + 1;
+                }
+                if (height != mask[i])
+                {
+                    span.capped = false;
+                }
+            }
+        }
+    } // namespace
+
+    AccumulationSpan accumulate_snow(HeightMap &heights, const HeightMap &mask,
+                                     int row, float amount)
+    {
+        const size_t count = heights.width();
+        const auto offset = row * count * heights.texel_size();
+        auto *texels = heights.data() + offset;
+        const auto *limits = mask.data() + offset;
+        auto span = AccumulationSpan{ count, 0, true };
+#if defined(__x86_64__) || defined(__i386__)
+        const bool avx2 = cpu_features().avx2;
+#else
+        const bool avx2 = false;
+#endif
+        switch (heights.precision())
+        {
+        case HeightMap::Precision::UNORM8: {
+            auto *h = reinterpret_cast<std::uint8_t *>(texels);
+            const auto *m = reinterpret_cast<const std::uint8_t *>(limits);
+            const auto steps = unorm_steps<std::uint8_t>(amount);
+            if (avx2)
+                kernels::accumulate_snow_unorm8_avx2(h, m, count, steps, span);
+            else
+                kernels::accumulate_snow_unorm8_scalar(h, m, 0, count, steps,
+                                                       span);
+            break;
+        }
+        case HeightMap::Precision::UNORM16: {
+            auto *h = reinterpret_cast<std::uint16_t *>(texels);
+            const auto *m = reinterpret_cast<const std::uint16_t *>(limits);
+            const auto steps = unorm_steps<std::uint16_t>(amount);
+            if (avx2)
+                kernels::accumulate_snow_unorm16_avx2(h, m, count, steps,
+                                                      span);
+            else
+                kernels::accumulate_snow_unorm16_scalar(h, m, 0, count, steps,
+                                                        span);
+            break;
+        }
+        case HeightMap::Precision::FLOAT16:
+            kernels::accumulate_snow_half_scalar(
+                reinterpret_cast<std::uint16_t *>(texels),
+                reinterpret_cast<const std::uint16_t *>(limits), 0, count,
+                amount, span);
+            break;
+        default: {
+            auto *h = reinterpret_cast<float *>(texels);
+            const auto *m = reinterpret_cast<const float *>(limits);
+            if (avx2)
+                kernels::accumulate_snow_avx2(h, m, count, amount, span);
+            else
+                kernels::accumulate_snow_scalar(h, m, 0, count, amount, span);
+            break;
+        }
+        }
+        return span;
+    }
+
+    namespace kernels
+    {
+        void accumulate_snow_scalar(float *heights, const float *mask,
+                                    size_t begin, size_t end, float amount,
+                                    AccumulationSpan &span)
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                const auto previous = heights[i];
+                const auto height = std::min(previous + amount, mask[i]);
+                heights[i] = height;
+                if (height != previous)
+                {
+                    span.first = std::min(span.first, i);
+                    span.end = i + 1;
+                }
+                if (height != mask[i])
+                {
+                    span.capped = false;
+                }
+            }
+        }
+
+        void accumulate_snow_unorm8_scalar(std::uint8_t *heights,
+                                           const std::uint8_t *mask,
+                                           size_t begin, size_t end,
+                                           std::uint8_t steps,
+                                           AccumulationSpan &span)
+        {
+            accumulate_unorm(heights, mask, begin, end, steps, span);
+        }
+
+        void accumulate_snow_unorm16_scalar(std::uint16_t *heights,
+                                            const std::uint16_t *mask,
+                                            size_t begin, size_t end,
+                                            std::uint16_t steps,
+                                            AccumulationSpan &span)
+        {
+            accumulate_unorm(heights, mask, begin, end, steps, span);
+        }
+
+        void accumulate_snow_half_scalar(std::uint16_t *heights,
+                                         const std::uint16_t *mask,
+                                         size_t begin, size_t end,
+                                         float amount, AccumulationSpan &span)
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                const auto previous = heights[i];
+                const auto height = float_to_half(std::min(
+                    half_to_float(previous) + amount, half_to_float(mask[i])));
+                heights[i] = height;
+                if (height != previous)
+                {
+                    span.first = std::min(span.first, i);
+                    span.end = i + 1;
+                }
+                if (height != mask[i])
+                {
+                    span.capped = false;
+                }
+            }
+        }
+    } // namespace kernels
+} // namespace pogl
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "image/height_map.hh"
+
+namespace pogl
+{
+    /**
+     * @brief What accumulate_snow did to a span: the texels in [first, end)
+     * changed, none when first >= end, and capped tells whether every texel
+     * of the span now equals its mask.
+     */
+    struct AccumulationSpan
+    {
+        size_t first;
+        size_t end;
+        bool capped;
+    };
+
+    /**
+     * @brief Adds amount to a row of heights, each capped by the mask texel
+     * at the same place, directly on the texels of their precision: unorm
+     * heights add whole steps with saturation.
+     *
+     * The kernel is picked among AVX2 and scalar implementations, both
+     * producing bit identical heights.
+     *
+     * @param heights
+     * @param mask same size and precision as heights
+     * @param row
+     * @param amount a multiple of the step of the precision, see
+     * HeightMap::quantize
+     * @return AccumulationSpan
+     */
+    AccumulationSpan accumulate_snow(HeightMap &heights, const HeightMap &mask,
+                                     int row, float amount);
+
+    namespace kernels
+    {
+        // span starts as { count, 0, true } and is extended in place
+        void accumulate_snow_scalar(float *heights, const float *mask,
+                                    size_t begin, size_t end, float amount,
+                                    AccumulationSpan &span);
+        void accumulate_snow_avx2(float *heights, const float *mask,
+                                  size_t count, float amount,
+                                  AccumulationSpan &span);
+        void accumulate_snow_unorm8_scalar(std::uint8_t *heights,
+                                           const std::uint8_t *mask,
+                                           size_t begin, size_t end,
+                                           std::uint8_t steps,
+                                           AccumulationSpan &span);
+        void accumulate_snow_unorm8_avx2(std::uint8_t *heights,
+                                         const std::uint8_t *mask,
+                                         size_t count, std::uint8_t steps,
+                                         AccumulationSpan &span);
+        void accumulate_snow_unorm16_scalar(std::uint16_t *heights,
+                                            const std::uint16_t *mask,
+                                            size_t begin, size_t end,
+                                            std::uint16_t steps,
+                                            AccumulationSpan &span);
+        void accumulate_snow_unorm16_avx2(std::uint16_t *heights,
+                                          const std::uint16_t *mask,
+                                          size_t count, std::uint16_t steps,
+                                          AccumulationSpan &span);
+        // half floats, converted one texel at a time
+        void accumulate_snow_half_scalar(std::uint16_t *heights,
+                                         const std::uint16_t *mask,
+                                         size_t begin, size_t end,
+                                         float amount, AccumulationSpan &span);
+    } // namespace kernels
+} // namespace pogl
@@ -0,0 +1,124 @@
+#include "snow_accumulation.hh"
+
+#if defined(__x86_64__) || defined(__i386__)
+#    include <algorithm>
+#    include <immintrin.h>
+
+namespace pogl::kernels
+{
+    // Eight heights at a time. min_ps(mask, sum) returns sum unless the mask
+    // is lower, like std::min(sum, mask), so both kernels give the same
+    // heights, NaN included.
+
+    __attribute__((target("avx2"))) void
+    accumulate_snow_avx2(float *heights, const float *mask, size_t count,
+                         float amount, AccumulationSpan &span)
+    {
+        constexpr size_t LANES = 8;
+        const auto amount_v = _mm256_set1_ps(amount);
+        auto uncapped = _mm256_setzero_ps();
+        size_t i = 0;
+        for (; i + LANES <= count; i += LANES)
+        {
+            const auto previous = _mm256_loadu_ps(heights + i);
+            const auto limit = _mm256_loadu_ps(mask + i);
+            const auto height =
+                _mm256_min_ps(limit, _mm256_add_ps(previous, amount_v));
+            _mm256_storeu_ps(heights + i, height);
+            uncapped = _mm256_or_ps(
+                uncapped, _mm256_cmp_ps(height, limit, _CMP_NEQ_UQ));
+            const unsigned changed = _mm256_movemask_ps(
+                _mm256_cmp_ps(height, previous, _CMP_NEQ_UQ));
+            if (changed != 0)
+            {
+                span.first =
+                    std::min<size_t>(span.first, i + __builtin_ctz(changed));
+                span.end = i + 32 - __builtin_clz(changed);
+            }
+        }
+        if (_mm256_movemask_ps(uncapped) != 0)
+        {
+            span.capped = false;
+        }
+        accumulate_snow_scalar(heights, mask, i, count, amount, span);
+    }
+
+    // Unorm heights stay integers: a saturating add of the steps then an
+    // unsigned min, 32 or 16 texels at a time. movemask gives one bit per
+    // byte, so two per 16 bit texel.
+
+    __attribute__((target("avx2"))) void
+    accumulate_snow_unorm8_avx2(std::uint8_t *heights,
+                                const std::uint8_t *mask, size_t count,
+                                std::uint8_t steps, AccumulationSpan &span)
+    {
+        constexpr size_t LANES = 32;
+        const auto steps_v = _mm256_set1_epi8((char)steps);
+        auto capped = _mm256_set1_epi8(-1);
+        size_t i = 0;
+        for (; i + LANES <= count; i += LANES)
+        {
+            const auto previous = _mm256_loadu_si256(
+                reinterpret_cast<const __m256i *>(heights + i));
+            const auto limit = _mm256_loadu_si256(
+                reinterpret_cast<const __m256i *>(mask + i));
+            const auto height =
+                _mm256_min_epu8(_mm256_adds_epu8(previous, steps_v), limit);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(heights + i),
+                                height);
+            capped = _mm256_and_si256(capped, _mm256_cmpeq_epi8(height, limit));
+            const unsigned changed = ~(unsigned)_mm256_movemask_epi8(
+                _mm256_cmpeq_epi8(height, previous));
+            if (changed != 0)
+            {
+                span.first =
+                    std::min<size_t>(span.first, i + __builtin_ctz(changed));
+                span.end = i + 32 - __builtin_clz(changed);
+            }
+        }
+        if ((unsigned)_mm256_movemask_epi8(capped) != 0xffffffffu)
+        {
+            span.capped = false;
+        }
+        accumulate_snow_unorm8_scalar(heights, mask, i, count, steps, span);
+    }
+
+    __attribute__((target("avx2"))) void
+    accumulate_snow_unorm16_avx2(std::uint16_t *heights,
+                                 const std::uint16_t *mask, size_t count,
+                                 std::uint16_t steps, AccumulationSpan &span)
+    {
+        constexpr size_t LANES = 16;
+        const auto steps_v = _mm256_set1_epi16((short)steps);
+        auto capped = _mm256_set1_epi16(-1);
+        size_t i = 0;
+        for (; i + LANES <= count; i += LANES)
+        {
+            const auto previous = _mm256_loadu_si256(
+                reinterpret_cast<const __m256i *>(heights + i));
+            const auto limit = _mm256_loadu_si256(
+                reinterpret_cast<const __m256i *>(mask + i));
+            const auto height =
+                _mm256_min_epu16(_mm256_adds_epu16(previous, steps_v), limit);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(heights + i),
+                                height);
+            capped =
+                _mm256_and_si256(capped, _mm256_cmpeq_epi16(height, limit));
+            const unsigned changed = ~(unsigned)_mm256_movemask_epi8(
+                _mm256_cmpeq_epi16(height, previous));
+            if (changed != 0)
+            {
+                span.first = std::min<size_t>(span.first,
+                                              i + __builtin_ctz(changed) / 2);
+                span.end = i + (32 - __builtin_clz(changed)) / 2;
+            }
+        }
+        if ((unsigned)_mm256_movemask_epi8(capped) != 0xffffffffu)
+        {
+            span.capped = false;
+        }
+        accumulate_snow_unorm16_scalar(heights, mask, i, count, steps, span);
+    }
+} // namespace pogl::kernels
+
+#endif // x86
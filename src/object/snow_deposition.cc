@@ -0,0 +1,187 @@
+#include "snow_deposition.hh"
+
+#include <algorithm>
+#include <cmath>
+
+namespace pogl
+{
+    namespace
+    {
+        // tiles merged by one job
+        constexpr size_t MERGE_CHUNK_SIZE = 4;
+    } // namespace
+
+    SnowDeposition::Accumulator::Accumulator(const SnowDeposition &deposition)
+        : _deposition(&deposition)
+        , _slots(deposition._tiles_x * deposition._tiles_y, -1)
+        , _touched()
+        , _tiles()
+    {}
+
+    bool SnowDeposition::Accumulator::empty() const
+    {
+        return _touched.empty();
+    }
+
+    float *SnowDeposition::Accumulator::tile(TileIndexType tile)
+    {
+        auto &slot = _slots[tile];
+        if (slot < 0)
+        {
+            slot = _touched.size();
+            _touched.push_back(tile);
+            // tiles are kept once allocated and zeroed when cleared
+            if ((size_t)slot == _tiles.size())
+            {
+                _tiles.emplace_back(TILE_SIZE * TILE_SIZE, 0.f);
+            }
+        }
+        return _tiles[slot].data();
+    }
+
+    const float *
+    SnowDeposition::Accumulator::find_tile(TileIndexType tile) const
+    {
+        const auto slot = _slots[tile];
+        return slot < 0 ? nullptr : _tiles[slot].data();
+    }
+
+    void SnowDeposition::Accumulator::clear()
+    {
+        for (size_t slot = 0; slot < _touched.size(); ++slot)
+        {
+            std::fill(_tiles[slot].begin(), _tiles[slot].end(), 0.f);
+            _slots[_touched[slot]] = -1;
+        }
+        _touched.clear();
+    }
+
+    void SnowDeposition::Accumulator::deposit(float u, float v)
+    {
+        const auto &deposition = *_deposition;
+        const auto radius = (float)deposition._radius;
+        // texel centers are at half integers
+        const auto center_x = u * deposition._width - 0.5f;
+        const auto center_y = v * deposition._height - 0.5f;
+        const auto first_x = std::max(0, (int)std::ceil(center_x - radius));
+        const auto last_x = std::min(deposition._width - 1,
+                                     (int)std::floor(center_x + radius));
+        const auto first_y = std::max(0, (int)std::ceil(center_y - radius));
+        const auto last_y = std::min(deposition._height - 1,
+                                     (int)std::floor(center_y + radius));
+
+        for (int y = first_y; y <= last_y; ++y)
+        {
+            const auto dy = y - center_y;
+            const auto tile_row = y / TILE_SIZE;
+            auto *row = (float *)nullptr;
+            auto row_tile = -1;
+            for (int x = first_x; x <= last_x; ++x)
+            {
+                const auto dx = x - center_x;
+                const auto weight =
+                    1.f - std::sqrt(dx * dx + dy * dy) / radius;
+                if (weight <= 0)
+                {
+                    continue;
+                }
+                // the row only changes tile on tile boundaries
+                const auto tile_index =
+                    tile_row * deposition._tiles_x + x / TILE_SIZE;
+                if (tile_index != row_tile)
+                {
+                    row_tile = tile_index;
+                    row = tile(tile_index) + (y % TILE_SIZE) * TILE_SIZE;
+                }
+                row[x % TILE_SIZE] += deposition._peak_height * weight;
+            }
+        }
+    }
+
+    SnowDeposition::SnowDeposition(int width, int height, float peak_height,
+                                   int radius)
+        : _width(width)
+        , _height(height)
+        , _tiles_x((width + TILE_SIZE - 1) / TILE_SIZE)
+        , _tiles_y((height + TILE_SIZE - 1) / TILE_SIZE)
+        , _peak_height(peak_height)
+        , _radius(std::max(radius, 1))
+        , _merged_tiles()
+    {}
+
+    void SnowDeposition::merge(std::span<Accumulator> accumulators,
+                               HeightMap &height, const HeightMap &mask,
+                               JobSystem &jobs)
+    {
+        _merged_tiles.clear();
+        for (const auto &accumulator : accumulators)
+        {
+            _merged_tiles.insert(_merged_tiles.end(),
+                                 accumulator._touched.begin(),
+                                 accumulator._touched.end());
+        }
+        std::sort(_merged_tiles.begin(), _merged_tiles.end());
+        _merged_tiles.erase(
+            std::unique(_merged_tiles.begin(), _merged_tiles.end()),
+            _merged_tiles.end());
+
+        jobs.parallel_for(
+            _merged_tiles.size(), MERGE_CHUNK_SIZE,
+            [&](size_t, size_t begin, size_t end) {
+                for (auto i = begin; i < end; ++i)
+                {
+                    const auto tile = _merged_tiles[i];
+                    const auto rect = tile_rect(tile);
+                    // accumulators are summed in order in float, then added
+                    // to the map once, the result does not depend on the
+                    // scheduling
+                    float sum[TILE_SIZE * TILE_SIZE] = {};
+                    for (const auto &accumulator : accumulators)
+                    {
+                        const auto *deposit = accumulator.find_tile(tile);
+                        if (deposit == nullptr)
+                        {
+                            continue;
+                        }
+                        for (int y = 0; y < rect.height; ++y)
+                        {
+                            for (int x = 0; x < rect.width; ++x)
+                            {
+                                sum[y * TILE_SIZE + x] +=
+                                    deposit[y * TILE_SIZE + x];
+                            }
+                        }
+                    }
+                    for (int y = 0; y < rect.height; ++y)
+                    {
+                        const size_t offset = (rect.y + y) * _width + rect.x;
+                        for (int x = 0; x < rect.width; ++x)
+                        {
+                            const auto texel = offset + x;
+                            height.set(texel,
+                                       std::min(height.get(texel)
+                                                    + sum[y * TILE_SIZE + x],
+                                                mask.get(texel)));
+                        }
+                    }
+                    height.mark_dirty(rect);
+                }
+            });
+
+        jobs.parallel_for(accumulators.size(), 1,
+                          [&](size_t, size_t begin, size_t end) {
+                              for (auto i = begin; i < end; ++i)
+                              {
+                                  accumulators[i].clear();
+                              }
+                          });
+    }
+
+    SnowDeposition::TileRect SnowDeposition::tile_rect(TileIndexType tile) const
+    {
+        const auto x = (tile % _tiles_x) * TILE_SIZE;
+        const auto y = (tile / _tiles_x) * TILE_SIZE;
+        return TileRect{ x, y, std::min(TILE_SIZE, _width - x),
+                         std::min(TILE_SIZE, _height - y) };
+    }
+} // namespace pogl
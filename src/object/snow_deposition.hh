@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "image/height_map.hh"
+#include "jobs/job_system.hh"
+
+namespace pogl
+{
+    /**
+     * @brief Scatters snow deposits into a height map from many threads.
+     *
+     * Every thread splats into its own Accumulator, which only allocates the
+     * TILE_SIZE square tiles it touches. merge() then adds the accumulators
+     * into the height map in parallel over tiles, so no two jobs ever write
+     * the same texel, and marks the tiles that changed dirty in the map.
+     */
+    class SnowDeposition
+    {
+    public:
+        static constexpr int TILE_SIZE = HeightMap::TILE_SIZE;
+        using TileIndexType = std::int32_t;
+
+        class Accumulator
+        {
+        public:
+            explicit Accumulator(const SnowDeposition &deposition);
+
+            /**
+             * @brief Adds a cone of snow centered on texture coordinates
+             * (u, v), clipped to the borders of the map.
+             *
+             * @param u
+             * @param v
+             */
+            void deposit(float u, float v);
+
+            bool empty() const;
+
+        private:
+            friend class SnowDeposition;
+
+            float *tile(TileIndexType tile);
+            const float *find_tile(TileIndexType tile) const;
+            void clear();
+
+            const SnowDeposition *_deposition;
+            // slot of each tile of the map, -1 when untouched
+            std::vector<std::int32_t> _slots;
+            // touched tiles, slot i holds tile _touched[i]
+            std::vector<TileIndexType> _touched;
+            std::vector<std::vector<float>> _tiles;
+        };
+
+        /**
+         * @brief Rectangle of a tile in texels, clipped to the map
+         */
+        using TileRect = HeightMap::Region;
+
+        /**
+         * @brief Deposition into a width by height map, every deposit is a
+         * cone of radius texels with peak_height at its center.
+         *
+         * @param width
+         * @param height
+         * @param peak_height
+         * @param radius
+         */
+        SnowDeposition(int width, int height, float peak_height, int radius);
+
+        /**
+         * @brief Adds every accumulator to height, clamped to mask, and
+         * empties them. The tiles touched are marked dirty in height.
+         *
+         * @param accumulators
+         * @param height width by height, any precision
+         * @param mask maximum height of each texel, same size as height
+         * @param jobs
+         */
+        void merge(std::span<Accumulator> accumulators,
+                   HeightMap &height, const HeightMap &mask,
+                   JobSystem &jobs);
+
+        TileRect tile_rect(TileIndexType tile) const;
+
+    private:
+        int _width;
+        int _height;
+        int _tiles_x;
+        int _tiles_y;
+        float _peak_height;
+        int _radius;
+        std::vector<TileIndexType> _merged_tiles;
+    };
+} // namespace pogl
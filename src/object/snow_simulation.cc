@@ -0,0 +1,214 @@
+#include "snow_simulation.hh"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "utils/buffer_offset_macro.hh"
+#include "utils/gl_check.hh"
+#include "utils/log.hh"
+
+namespace pogl
+{
+    namespace
+    {
+        std::shared_ptr<Texture> make_target(GLsizei width, GLsizei height)
+        {
+            // sampled by the ground shader like the CPU height map
+            return Texture::builder()
+                .buffer(FloatImageBuffer::sized(width, height, 1))
+                .wrap(GL_CLAMP_TO_BORDER)
+                .border(Vector4(0, 0, 0, 1))
+                .src_format(GL_RED)
+                .format(GL_R32F)
+                .min_filter(GL_LINEAR)
+                .build();
+        }
+    } // namespace
+
+    SnowSimulation::SnowSimulation(std::shared_ptr<ShaderProgram> program,
+                                   std::shared_ptr<Texture> mask,
+                                   GLsizei width, GLsizei height,
+                                   float diffusion_rate)
+        : _program(program)
+        , _mask(mask)
+        , _targets{ make_target(width, height), make_target(width, height) }
+        , _framebuffer_ids{ 0, 0 }
+        , _current(0)
+        , _vao(0)
+        , _width(width)
+        , _height(height)
+        , _diffusion_rate(diffusion_rate)
+        , _amount_uniform(program->uniform("amount"))
+        , _diffusion_uniform(program->uniform("diffusion"))
+        , _readback_buffer_id(0)
+        , _readback_fence(nullptr)
+        , _readback(std::make_shared<HeightMap>(width, height,
+                                                HeightMap::Precision::FLOAT32))
+    {
+        glGenFramebuffers(_framebuffer_ids.size(), _framebuffer_ids.data());
+        CHECK_GL_ERROR();
+        for (size_t i = 0; i < _framebuffer_ids.size(); ++i)
+        {
+            glBindFramebuffer(GL_FRAMEBUFFER, _framebuffer_ids[i]);
+            CHECK_GL_ERROR();
+            _targets[i]->attach(GL_COLOR_ATTACHMENT0);
+            const auto status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+            CHECK_GL_ERROR();
+            if (status != GL_FRAMEBUFFER_COMPLETE)
+            {
+                glBindFramebuffer(GL_FRAMEBUFFER, 0);
+                std::cerr << LOG_ERROR << "snow framebuffer is incomplete ("
+                          << status << ")" << std::endl;
+                throw std::logic_error("Incomplete snow framebuffer");
+            }
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        CHECK_GL_ERROR();
+        // core profile requires a bound VAO to draw, even without attributes
+        glGenVertexArrays(1, &_vao);
+        CHECK_GL_ERROR();
+
+        glGenBuffers(1, &_readback_buffer_id);
+        CHECK_GL_ERROR();
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, _readback_buffer_id);
+        CHECK_GL_ERROR();
+        glBufferData(GL_PIXEL_PACK_BUFFER,
+                     (size_t)width * height * _readback->texel_size(), nullptr,
+                     GL_STREAM_READ);
+        CHECK_GL_ERROR();
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        CHECK_GL_ERROR();
+
+        _program->set_texture(MASK_UNIT, _mask);
+        auto previous_u = _program->uniform("previous");
+        if (previous_u)
+            previous_u->set_int(PREVIOUS_UNIT);
+        auto mask_u = _program->uniform("snow_mask");
+        if (mask_u)
+            mask_u->set_int(MASK_UNIT);
+    }
+
+    SnowSimulation::~SnowSimulation()
+    {
+        if (_readback_fence != nullptr)
+        {
+            glDeleteSync(_readback_fence);
+            CHECK_GL_ERROR();
+        }
+        glDeleteBuffers(1, &_readback_buffer_id);
+        CHECK_GL_ERROR();
+        glDeleteVertexArrays(1, &_vao);
+        CHECK_GL_ERROR();
+        glDeleteFramebuffers(_framebuffer_ids.size(), _framebuffer_ids.data());
+        CHECK_GL_ERROR();
+    }
+
+    void SnowSimulation::step(float amount, float delta)
+    {
+        const auto next = 1 - _current;
+        GLint viewport[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        CHECK_GL_ERROR();
+        glBindFramebuffer(GL_FRAMEBUFFER, _framebuffer_ids[next]);
+        CHECK_GL_ERROR();
+        glViewport(0, 0, _width, _height);
+        CHECK_GL_ERROR();
+        // the target has no depth, the output replaces the texel
+        const auto blend = glIsEnabled(GL_BLEND);
+        CHECK_GL_ERROR();
+        glDisable(GL_BLEND);
+        CHECK_GL_ERROR();
+
+        if (_amount_uniform)
+            _amount_uniform->set_float(amount);
+        // past a share of 1 the texels would overshoot their neighbours
+        if (_diffusion_uniform)
+            _diffusion_uniform->set_float(
+                std::min(_diffusion_rate * delta, 1.f));
+        _program->set_texture(PREVIOUS_UNIT, _targets[_current]);
+        _program->use();
+        glBindVertexArray(_vao);
+        CHECK_GL_ERROR();
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        CHECK_GL_ERROR();
+        glBindVertexArray(0);
+        CHECK_GL_ERROR();
+
+        if (blend)
+        {
+            glEnable(GL_BLEND);
+            CHECK_GL_ERROR();
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        CHECK_GL_ERROR();
+        glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+        CHECK_GL_ERROR();
+        _current = next;
+    }
+
+    std::shared_ptr<Texture> SnowSimulation::current() const
+    {
+        return _targets[_current];
+    }
+
+    void SnowSimulation::request_readback()
+    {
+        if (_readback_fence != nullptr)
+        {
+            return;
+        }
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, _framebuffer_ids[_current]);
+        CHECK_GL_ERROR();
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, _readback_buffer_id);
+        CHECK_GL_ERROR();
+        // into the buffer, glReadPixels returns without waiting
+        glReadPixels(0, 0, _width, _height, GL_RED, GL_FLOAT,
+                     BUFFER_OFFSET(0));
+        CHECK_GL_ERROR();
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        CHECK_GL_ERROR();
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+        CHECK_GL_ERROR();
+        _readback_fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        CHECK_GL_ERROR();
+    }
+
+    bool SnowSimulation::poll_readback()
+    {
+        if (_readback_fence == nullptr)
+        {
+            return false;
+        }
+        const auto status = glClientWaitSync(_readback_fence, 0, 0);
+        CHECK_GL_ERROR();
+        if (status == GL_TIMEOUT_EXPIRED)
+        {
+            return false;
+        }
+        glDeleteSync(_readback_fence);
+        CHECK_GL_ERROR();
+        _readback_fence = nullptr;
+
+        const auto size = (size_t)_width * _height * _readback->texel_size();
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, _readback_buffer_id);
+        CHECK_GL_ERROR();
+        const auto *mapping =
+            glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT);
+        CHECK_GL_ERROR();
+        if (mapping != nullptr)
+        {
+            std::memcpy(_readback->data(), mapping, size);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            CHECK_GL_ERROR();
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        CHECK_GL_ERROR();
+        return mapping != nullptr;
+    }
+
+    std::shared_ptr<const HeightMap> SnowSimulation::heights() const
+    {
+        return _readback;
+    }
+} // namespace pogl
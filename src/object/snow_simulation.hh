@@ -0,0 +1,108 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <array>
+#include <memory>
+#include <optional>
+
+#include "image/height_map.hh"
+#include "shader_program/shader_program.hh"
+#include "shader_program/uniform.hh"
+#include "texture/texture.hh"
+
+namespace pogl
+{
+    /**
+     * @brief Snow height map simulated on the GPU.
+     *
+     * The height lives in two R32F textures used in turn: every step draws
+     * a full screen triangle into one of them, reading the other, which
+     * grows the snow, optionally diffuses it between neighbouring texels and
+     * caps it by the mask. Nothing goes through the CPU, except the copies
+     * asked for with request_readback, which arrive a few frames later
+     * through a pixel pack buffer.
+     */
+    class SnowSimulation
+    {
+    public:
+        /**
+         * @brief Texture units of the simulation program
+         */
+        static constexpr int PREVIOUS_UNIT = 0;
+        static constexpr int MASK_UNIT = 1;
+
+        /**
+         * @param program draws the next height from `previous` and
+         * `snow_mask`, given the `amount` and `diffusion` uniforms
+         * @param mask highest snow height of every texel, in any single
+         * channel format, sampled normalized
+         * @param width of the mask
+         * @param height of the mask
+         * @param diffusion_rate share of the difference with the neighbours
+         * averaged in per second, 0 disables diffusion
+         */
+        SnowSimulation(std::shared_ptr<ShaderProgram> program,
+                       std::shared_ptr<Texture> mask, GLsizei width,
+                       GLsizei height, float diffusion_rate);
+        ~SnowSimulation();
+
+        SnowSimulation(const SnowSimulation &) = delete;
+        SnowSimulation &operator=(const SnowSimulation &) = delete;
+
+        /**
+         * @brief Diffuses the height over delta seconds then adds amount to
+         * every texel, capped by the mask. The share diffused in one step
+         * is at most 1.
+         *
+         * @param amount
+         * @param delta
+         */
+        void step(float amount, float delta);
+
+        /**
+         * @brief Texture holding the height after the last step
+         *
+         * @return std::shared_ptr<Texture>
+         */
+        std::shared_ptr<Texture> current() const;
+
+        /**
+         * @brief Starts copying the current height to the CPU, unless a copy
+         * is already on its way. Does not wait for the GPU.
+         */
+        void request_readback();
+
+        /**
+         * @brief Moves the requested copy into heights() once the GPU is done
+         * with it, without waiting.
+         *
+         * @return bool whether heights() changed
+         */
+        bool poll_readback();
+
+        /**
+         * @brief Last height read back, zero until the first copy arrives.
+         * Later copies land in the same map, shared with its readers.
+         *
+         * @return std::shared_ptr<const HeightMap> float precision
+         */
+        std::shared_ptr<const HeightMap> heights() const;
+
+    private:
+        std::shared_ptr<ShaderProgram> _program;
+        std::shared_ptr<Texture> _mask;
+        std::array<std::shared_ptr<Texture>, 2> _targets;
+        // framebuffer i renders into _targets[i]
+        std::array<GLuint, 2> _framebuffer_ids;
+        size_t _current;
+        GLuint _vao;
+        GLsizei _width;
+        GLsizei _height;
+        float _diffusion_rate;
+        std::optional<Uniform> _amount_uniform;
+        std::optional<Uniform> _diffusion_uniform;
+        GLuint _readback_buffer_id;
+        GLsync _readback_fence;
+        std::shared_ptr<HeightMap> _readback;
+    };
+} // namespace pogl
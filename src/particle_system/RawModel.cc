@@ -1,21 +1,23 @@
 #include "RawModel.hh"
 
+#include <utility>
+
 namespace pogl {
-    RawModel::RawModel(GLuint VAO, int vertexCount, std::vector<GLuint> VBO_ids)
+    RawModel::RawModel(GLuint VAO, int vertexCount, std::shared_ptr<StreamBuffer> instances)
         : VAO(VAO)
         , vertexCount(vertexCount)
-        , VBO_ids(VBO_ids)
+        , instances(std::move(instances))
     {}
 
-    int RawModel::getVertexCount() {
+    int RawModel::getVertexCount() const {
         return vertexCount;
     }
 
-    GLuint RawModel::getVAO() {
+    GLuint RawModel::getVAO() const {
         return VAO;
     }
 
-    std::vector<GLuint> RawModel::getVBOs() {
-        return VBO_ids;
+    const std::shared_ptr<StreamBuffer>& RawModel::getInstances() const {
+        return instances;
     }
-}
\ No newline at end of file
+}
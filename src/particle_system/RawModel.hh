@@ -1,27 +1,38 @@
 #pragma once
 
 #include <GL/glew.h>
+#include "buffer/stream_buffer.hh"
 #include "utils/gl_check.hh"
-#include <vector>
+#include <memory>
 
 namespace pogl {
     class RawModel {
         public:
             RawModel() = default;
 
-            RawModel(RawModel& RM) = default;
+            RawModel(const RawModel& RM) = default;
 
-            RawModel(GLuint VAO, int vertexCount, std::vector<GLuint> VBO_ids);
+            RawModel& operator=(const RawModel& RM) = default;
 
-            int getVertexCount();
+            /**
+             * @brief Model drawn from per-instance attributes streamed into
+             * instances, which the model shares.
+             */
+            RawModel(GLuint VAO, int vertexCount, std::shared_ptr<StreamBuffer> instances);
 
-            GLuint getVAO();
+            int getVertexCount() const;
 
-            std::vector<GLuint> getVBOs();
+            GLuint getVAO() const;
+
+            /**
+             * @brief Ring buffer of the per-instance attributes, null for
+             * default constructed models
+             */
+            const std::shared_ptr<StreamBuffer>& getInstances() const;
 
         private:
             GLuint VAO;
             int vertexCount;
-            std::vector<GLuint> VBO_ids;
+            std::shared_ptr<StreamBuffer> instances;
     };
-}
\ No newline at end of file
+}
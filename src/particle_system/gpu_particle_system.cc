@@ -0,0 +1,238 @@
+#include "gpu_particle_system.hh"
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+#include "engine/engine.hh"
+#include "utils/gl_check.hh"
+#include "utils/log.hh"
+#include "utils/rng.hh"
+
+namespace pogl
+{
+    namespace
+    {
+        void set_int_uniform(ShaderProgram &program, const char *name,
+                             GLint value)
+        {
+            auto uniform = program.uniform(name);
+            if (uniform)
+                uniform->set_int(value);
+        }
+
+        void set_float_uniform(ShaderProgram &program, const char *name,
+                               GLfloat value)
+        {
+            auto uniform = program.uniform(name);
+            if (uniform)
+                uniform->set_float(value);
+        }
+    } // namespace
+
+    GpuParticleSystem::GpuParticleSystem(
+        std::shared_ptr<ShaderProgram> simulation,
+        std::shared_ptr<ShaderProgram> shader, size_t particle_count,
+        size_t texture_count)
+        : _simulation(simulation)
+        , _shader(shader)
+        , _depth_keys(nullptr)
+        , _sort(nullptr)
+        , _particle_count(particle_count)
+        , _padded_count(std::bit_ceil(std::max(particle_count, SORT_BLOCK_SIZE)))
+        , _particle_buffer(0)
+        , _order_buffer(0)
+        , _vao(0)
+        , _seed(static_cast<std::uint32_t>(global_seed()))
+        , _frame(0)
+    {
+        // the billboard vertex shader reads the particle buffer, which not
+        // every implementation allows
+        GLint vertex_storage_blocks = 0;
+        glGetIntegerv(GL_MAX_VERTEX_SHADER_STORAGE_BLOCKS,
+                      &vertex_storage_blocks);
+        CHECK_GL_ERROR();
+        if (vertex_storage_blocks < 1)
+        {
+            std::cerr << LOG_ERROR
+                      << "vertex shaders cannot read shader storage buffers, "
+                         "GPU particles are unavailable"
+                      << std::endl;
+            throw std::logic_error("No shader storage in vertex shaders");
+        }
+
+        glCreateBuffers(1, &_particle_buffer);
+        CHECK_GL_ERROR();
+        glNamedBufferStorage(_particle_buffer, _particle_count * PARTICLE_SIZE,
+                             nullptr, 0);
+        CHECK_GL_ERROR();
+        // core profile requires a bound VAO to draw, even without attributes
+        glCreateVertexArrays(1, &_vao);
+        CHECK_GL_ERROR();
+
+        auto &program = *_simulation;
+        set_int_uniform(program, "particle_count", _particle_count);
+        set_int_uniform(program, "seed", _seed);
+        set_float_uniform(program, "respawn_height", RESPAWN_HEIGHT);
+        set_float_uniform(program, "initial_height", INITIAL_HEIGHT);
+        set_float_uniform(program, "texture_count", texture_count);
+        set_float_uniform(program, "max_angular_velocity",
+                          MAX_ANGULAR_VELOCITY);
+        auto spawn_center = program.uniform("spawn_center");
+        if (spawn_center)
+            spawn_center->set_vec3(SPAWN_CENTER);
+
+        simulate(0, true);
+    }
+
+    GpuParticleSystem::~GpuParticleSystem()
+    {
+        glDeleteVertexArrays(1, &_vao);
+        CHECK_GL_ERROR();
+        glDeleteBuffers(1, &_particle_buffer);
+        CHECK_GL_ERROR();
+        if (_order_buffer != 0)
+        {
+            glDeleteBuffers(1, &_order_buffer);
+            CHECK_GL_ERROR();
+        }
+    }
+
+    void GpuParticleSystem::update(double delta)
+    {
+        simulate(delta, false);
+    }
+
+    void GpuParticleSystem::set_sort_programs(
+        std::shared_ptr<ShaderProgram> depth_keys,
+        std::shared_ptr<ShaderProgram> sort)
+    {
+        const bool sorted = depth_keys != nullptr && sort != nullptr;
+        if (sorted && _order_buffer == 0)
+        {
+            // the vertex shader reads both the particles and their order
+            GLint vertex_storage_blocks = 0;
+            glGetIntegerv(GL_MAX_VERTEX_SHADER_STORAGE_BLOCKS,
+                          &vertex_storage_blocks);
+            CHECK_GL_ERROR();
+            if (vertex_storage_blocks < 2)
+            {
+                std::cerr << LOG_WARNING
+                          << "vertex shaders cannot read two shader storage "
+                             "buffers, GPU particles stay unsorted"
+                          << std::endl;
+                return;
+            }
+            glCreateBuffers(1, &_order_buffer);
+            CHECK_GL_ERROR();
+            glNamedBufferStorage(_order_buffer,
+                                 _padded_count * 2 * sizeof(GLuint), nullptr,
+                                 0);
+            CHECK_GL_ERROR();
+        }
+
+        _depth_keys = sorted ? depth_keys : nullptr;
+        _sort = sorted ? sort : nullptr;
+        if (sorted)
+        {
+            set_int_uniform(*_depth_keys, "particle_count", _particle_count);
+            set_int_uniform(*_depth_keys, "padded_count", _padded_count);
+        }
+        set_int_uniform(*_shader, "sorted", sorted);
+    }
+
+    void GpuParticleSystem::sort(const Vector3 &origin)
+    {
+        auto origin_u = _depth_keys->uniform("sort_origin");
+        if (origin_u)
+            origin_u->set_vec3(origin);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, PARTICLE_BUFFER_BINDING,
+                         _particle_buffer);
+        CHECK_GL_ERROR();
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, ORDER_BUFFER_BINDING,
+                         _order_buffer);
+        CHECK_GL_ERROR();
+        _depth_keys->dispatch(_padded_count / WORK_GROUP_SIZE);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+        CHECK_GL_ERROR();
+
+        // bitonic merges of growing sequences, every gap shorter than a
+        // block is handled by one dispatch working in shared memory
+        dispatch_sort(SortPass::SORT_BLOCKS, SORT_BLOCK_SIZE, 0);
+        for (size_t size = 2 * SORT_BLOCK_SIZE; size <= _padded_count;
+             size *= 2)
+        {
+            for (size_t gap = size / 2; gap >= SORT_BLOCK_SIZE; gap /= 2)
+            {
+                dispatch_sort(SortPass::MERGE_GLOBAL, size, gap);
+            }
+            dispatch_sort(SortPass::MERGE_BLOCKS, size, SORT_BLOCK_SIZE / 2);
+        }
+    }
+
+    GLuint GpuParticleSystem::order_buffer() const
+    {
+        return _order_buffer;
+    }
+
+    GLuint GpuParticleSystem::particle_buffer() const
+    {
+        return _particle_buffer;
+    }
+
+    void GpuParticleSystem::dispatch_sort(SortPass pass, size_t merge_size,
+                                          size_t merge_gap)
+    {
+        auto &program = *_sort;
+        set_int_uniform(program, "sort_pass", static_cast<GLint>(pass));
+        set_int_uniform(program, "merge_size", merge_size);
+        set_int_uniform(program, "merge_gap", merge_gap);
+        // one invocation per compared pair
+        program.dispatch(_padded_count / SORT_BLOCK_SIZE);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+        CHECK_GL_ERROR();
+    }
+
+    void GpuParticleSystem::draw()
+    {
+        if (_sort)
+        {
+            // same reference point as ParticleRenderer::sort_particles
+            sort(Engine::instance().main_camera->get_position());
+        }
+        _shader->use();
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, PARTICLE_BUFFER_BINDING,
+                         _particle_buffer);
+        CHECK_GL_ERROR();
+        if (_sort)
+        {
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, ORDER_BUFFER_BINDING,
+                             _order_buffer);
+            CHECK_GL_ERROR();
+        }
+        glBindVertexArray(_vao);
+        CHECK_GL_ERROR();
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, _particle_count);
+        CHECK_GL_ERROR();
+        glBindVertexArray(0);
+        CHECK_GL_ERROR();
+    }
+
+    void GpuParticleSystem::simulate(float delta, bool spawn_all)
+    {
+        auto &program = *_simulation;
+        set_float_uniform(program, "delta", delta);
+        set_int_uniform(program, "frame", _frame++);
+        set_int_uniform(program, "spawn_all", spawn_all);
+
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, PARTICLE_BUFFER_BINDING,
+                         _particle_buffer);
+        CHECK_GL_ERROR();
+        const auto group_count =
+            (_particle_count + WORK_GROUP_SIZE - 1) / WORK_GROUP_SIZE;
+        program.dispatch(group_count);
+        // the vertex shader reads what the compute shader wrote
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+        CHECK_GL_ERROR();
+    }
+} // namespace pogl
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "properties/drawable.hh"
+#include "properties/updateable.hh"
+#include "shader_program/shader_program.hh"
+#include "vector3/vector3.hh"
+
+namespace pogl
+{
+    /**
+     * @brief Snow particle system simulated entirely on the GPU.
+     *
+     * Particles live in a shader storage buffer: a compute program integrates
+     * and respawns them, and the billboard vertex shader reads them back by
+     * instance id. No particle data is kept on the CPU side.
+     */
+    class GpuParticleSystem
+        : public Updateable
+        , public Drawable
+    {
+    public:
+        /**
+         * @brief Must match local_size_x in the simulation shader
+         */
+        static constexpr GLuint WORK_GROUP_SIZE = 64;
+        /**
+         * @brief Binding point of the particle buffer in both programs
+         */
+        static constexpr GLuint PARTICLE_BUFFER_BINDING = 0;
+        /**
+         * @brief Size of the std430 `Particle` struct: position and rotation,
+         * velocity and angular velocity, then scale and texture id.
+         */
+        static constexpr size_t PARTICLE_SIZE = 3 * 4 * sizeof(GLfloat);
+        /**
+         * @brief Binding point of the (key, index) order buffer
+         */
+        static constexpr GLuint ORDER_BUFFER_BINDING = 1;
+        /**
+         * @brief Elements sorted in shared memory by one work group, must
+         * match BLOCK_SIZE in the sort shader
+         */
+        static constexpr size_t SORT_BLOCK_SIZE = 2 * WORK_GROUP_SIZE;
+
+        /**
+         * @brief Spawn parameters, the same as the CPU particle system:
+         * flakes respawn at SPAWN_CENTER once below RESPAWN_HEIGHT, the first
+         * spawn fills the column from RESPAWN_HEIGHT to INITIAL_HEIGHT.
+         */
+        static constexpr Vector3 SPAWN_CENTER = Vector3(0, 0, 10);
+        static constexpr float INITIAL_HEIGHT = 6;
+        static constexpr float RESPAWN_HEIGHT = -1.1;
+        static constexpr float MAX_ANGULAR_VELOCITY = 120;
+
+        /**
+         * @brief Passes of the sort shader, must match its constants
+         */
+        enum class SortPass : GLint
+        {
+            SORT_BLOCKS = 0,
+            MERGE_GLOBAL = 1,
+            MERGE_BLOCKS = 2,
+        };
+
+        GpuParticleSystem(std::shared_ptr<ShaderProgram> simulation,
+                          std::shared_ptr<ShaderProgram> shader,
+                          size_t particle_count, size_t texture_count);
+        virtual ~GpuParticleSystem();
+
+        GpuParticleSystem(const GpuParticleSystem &) = delete;
+        GpuParticleSystem &operator=(const GpuParticleSystem &) = delete;
+
+        virtual void update(double delta) override;
+        virtual void draw() override;
+
+        /**
+         * @brief Sorts the particles by distance to the camera on the GPU
+         * before every draw, in the order of ParticleRenderer::sort_particles.
+         * Null programs go back to drawing in simulation order.
+         *
+         * @param depth_keys program writing the (key, index) pairs
+         * @param sort bitonic sort program ordering the pairs in place
+         */
+        void set_sort_programs(std::shared_ptr<ShaderProgram> depth_keys,
+                               std::shared_ptr<ShaderProgram> sort);
+
+        /**
+         * @brief Writes the depth keys of the particles and sorts them, the
+         * order buffer then holds the particle indices from the farthest to
+         * the nearest to origin.
+         *
+         * @param origin point the distances are measured from
+         */
+        void sort(const Vector3 &origin);
+
+        /**
+         * @brief Order buffer, particle_count (key, index) pairs of two
+         * unsigned integers followed by the padding
+         *
+         * @return GLuint
+         */
+        GLuint order_buffer() const;
+
+        /**
+         * @brief Particle buffer, particle_count std430 `Particle` structs
+         * of PARTICLE_SIZE bytes
+         *
+         * @return GLuint
+         */
+        GLuint particle_buffer() const;
+
+    private:
+        /**
+         * @brief Runs the simulation program over every particle.
+         *
+         * @param delta time step in seconds
+         * @param spawn_all respawn every particle instead of integrating
+         */
+        void simulate(float delta, bool spawn_all);
+        void dispatch_sort(SortPass pass, size_t merge_size, size_t merge_gap);
+
+        std::shared_ptr<ShaderProgram> _simulation;
+        std::shared_ptr<ShaderProgram> _shader;
+        std::shared_ptr<ShaderProgram> _depth_keys;
+        std::shared_ptr<ShaderProgram> _sort;
+        size_t _particle_count;
+        // power of two, at least one sort block
+        size_t _padded_count;
+        GLuint _particle_buffer;
+        GLuint _order_buffer;
+        GLuint _vao;
+        std::uint32_t _seed;
+        std::uint32_t _frame;
+    };
+} // namespace pogl
@@ -0,0 +1,115 @@
+#include "integration.hh"
+
+#include <cmath>
+#include <iostream>
+
+#include "utils/cpu_features.hh"
+#include "utils/log.hh"
+
+namespace pogl
+{
+    namespace kernels
+    {
+        size_t integrate_scalar(const ParticleView &view, size_t begin,
+                                float dt, float kill_height,
+                                IndexType *dead_indices, size_t count)
+        {
+            for (size_t i = begin; i < view.size; ++i)
+            {
+                view.lifetime[i] -= dt;
+                if (view.z[i] < kill_height)
+                {
+                    dead_indices[count++] = i;
+                    continue;
+                }
+                view.x[i] += view.vx[i] * dt;
+                view.y[i] += view.vy[i] * dt;
+                view.z[i] += view.vz[i] * dt;
+                view.rotation[i] += view.angular_velocity[i] * dt;
+                if (view.lifetime[i] <= 0)
+                {
+                    dead_indices[count++] = i;
+                }
+            }
+            return count;
+        }
+    } // namespace kernels
+
+    namespace
+    {
+        using KernelType = size_t (*)(const ParticleView &, float, float,
+                                      IndexType *);
+
+        size_t integrate_fallback(const ParticleView &view, float dt,
+                                  float kill_height,
+                                  IndexType *dead_indices)
+        {
+            return kernels::integrate_scalar(view, 0, dt, kill_height,
+                                             dead_indices, 0);
+        }
+
+        struct Kernel
+        {
+            KernelType function;
+            const char *name;
+        };
+
+        const Kernel &select_kernel()
+        {
+            static const Kernel kernel = []() {
+                const auto &features = cpu_features();
+                Kernel selected{ integrate_fallback, "scalar" };
+#if defined(__x86_64__) || defined(__i386__)
+                if (features.avx2)
+                {
+                    selected = Kernel{ kernels::integrate_avx2, "avx2" };
+                }
+                else if (features.sse42)
+                {
+                    selected = Kernel{ kernels::integrate_sse42, "sse4.2" };
+                }
+#else
+                (void)features;
+#endif
+                std::cout << LOG_INFO << "particle integration kernel: "
+                          << selected.name << "\n";
+                return selected;
+            }();
+            return kernel;
+        }
+    } // namespace
+
+    size_t integrate_particles(const ParticleView &view, float dt,
+                               float kill_height,
+                               IndexType *dead_indices)
+    {
+        return select_kernel().function(view, dt, kill_height,
+                                        dead_indices);
+    }
+
+    namespace
+    {
+        void wrap_axis(float *values, size_t count, float min, float size)
+        {
+            const auto inverse_size = 1.f / size;
+            for (size_t i = 0; i < count; ++i)
+            {
+                const auto cells = std::floor((values[i] - min) * inverse_size);
+                values[i] -= cells * size;
+            }
+        }
+    } // namespace
+
+    void wrap_particles(const ParticleView &view, const Vector3 &box_min,
+                        const Vector3 &box_size)
+    {
+        wrap_axis(view.x, view.size, box_min.x, box_size.x);
+        wrap_axis(view.y, view.size, box_min.y, box_size.y);
+        wrap_axis(view.z, view.size, box_min.z, box_size.z);
+    }
+
+    const char *integration_kernel_name()
+    {
+        return select_kernel().name;
+    }
+} // namespace pogl
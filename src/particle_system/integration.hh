@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "particle_storage.hh"
+
+namespace pogl
+{
+    using IndexType = std::uint32_t;
+
+    /**
+     * @brief Advances position and rotation of every particle in view by dt
+     * and consumes dt of their lifetime. Particles whose height is below
+     * kill_height are left untouched, those and the particles whose lifetime
+     * ran out are dead: their index (relative to the view) is appended to
+     * dead_indices, in increasing order.
+     *
+     * The kernel is picked at first call among AVX2, SSE4.2 and scalar
+     * implementations, all of them producing bit identical results.
+     *
+     * @param view particles to integrate
+     * @param dt time step in seconds
+     * @param kill_height height under which a particle dies
+     * @param dead_indices output, must hold at least view.size elements
+     * @return size_t number of indices written in dead_indices
+     */
+    size_t integrate_particles(const ParticleView &view, float dt,
+                               float kill_height,
+                               IndexType *dead_indices);
+
+    /**
+     * @brief Moves every particle of view back into the box starting at
+     * box_min of extent box_size, wrapping around each axis independently as
+     * if the box was tiled over space.
+     *
+     * @param view particles to wrap
+     * @param box_min lowest corner of the box
+     * @param box_size size of the box along each axis, all positive
+     */
+    void wrap_particles(const ParticleView &view, const Vector3 &box_min,
+                        const Vector3 &box_size);
+
+    /**
+     * @brief Name of the kernel used by integrate_particles, for logging.
+     */
+    const char *integration_kernel_name();
+
+    namespace kernels
+    {
+        size_t integrate_scalar(const ParticleView &view, size_t begin,
+                                float dt, float kill_height,
+                                IndexType *dead_indices, size_t count);
+        size_t integrate_sse42(const ParticleView &view, float dt,
+                               float kill_height,
+                               IndexType *dead_indices);
+        size_t integrate_avx2(const ParticleView &view, float dt,
+                              float kill_height,
+                              IndexType *dead_indices);
+    } // namespace kernels
+} // namespace pogl
@@ -0,0 +1,110 @@
+#include "integration.hh"
+
+#if defined(__x86_64__) || defined(__i386__)
+#    include <immintrin.h>
+
+namespace pogl::kernels
+{
+    // Each lane computes `p + v * dt` with a separate multiply and add, like
+    // the scalar kernel, so that every implementation gives the same bits.
+    // Lanes under the kill height keep their values through a blend, they
+    // and the lanes whose lifetime ran out are reported from the dead mask.
+
+    __attribute__((target("avx2"))) size_t
+    integrate_avx2(const ParticleView &view, float dt, float kill_height,
+                   IndexType *dead_indices)
+    {
+        constexpr size_t LANES = 8;
+        const auto dt_v = _mm256_set1_ps(dt);
+        const auto kill_v = _mm256_set1_ps(kill_height);
+        size_t count = 0;
+        size_t i = 0;
+        for (; i + LANES <= view.size; i += LANES)
+        {
+            const auto z = _mm256_loadu_ps(view.z + i);
+            const auto reset = _mm256_cmp_ps(z, kill_v, _CMP_LT_OQ);
+            const auto lifetime =
+                _mm256_sub_ps(_mm256_loadu_ps(view.lifetime + i), dt_v);
+            const auto expired =
+                _mm256_cmp_ps(lifetime, _mm256_setzero_ps(), _CMP_LE_OQ);
+
+            const auto x = _mm256_loadu_ps(view.x + i);
+            const auto y = _mm256_loadu_ps(view.y + i);
+            const auto rot = _mm256_loadu_ps(view.rotation + i);
+            const auto nx = _mm256_add_ps(
+                x, _mm256_mul_ps(_mm256_loadu_ps(view.vx + i), dt_v));
+            const auto ny = _mm256_add_ps(
+                y, _mm256_mul_ps(_mm256_loadu_ps(view.vy + i), dt_v));
+            const auto nz = _mm256_add_ps(
+                z, _mm256_mul_ps(_mm256_loadu_ps(view.vz + i), dt_v));
+            const auto nrot = _mm256_add_ps(
+                rot,
+                _mm256_mul_ps(_mm256_loadu_ps(view.angular_velocity + i),
+                              dt_v));
+
+            _mm256_storeu_ps(view.x + i, _mm256_blendv_ps(nx, x, reset));
+            _mm256_storeu_ps(view.y + i, _mm256_blendv_ps(ny, y, reset));
+            _mm256_storeu_ps(view.z + i, _mm256_blendv_ps(nz, z, reset));
+            _mm256_storeu_ps(view.rotation + i,
+                             _mm256_blendv_ps(nrot, rot, reset));
+            _mm256_storeu_ps(view.lifetime + i, lifetime);
+
+            unsigned bits = _mm256_movemask_ps(_mm256_or_ps(reset, expired));
+            while (bits)
+            {
+                dead_indices[count++] = i + __builtin_ctz(bits);
+                bits &= bits - 1;
+            }
+        }
+        return integrate_scalar(view, i, dt, kill_height, dead_indices,
+                                count);
+    }
+
+    __attribute__((target("sse4.2"))) size_t
+    integrate_sse42(const ParticleView &view, float dt, float kill_height,
+                    IndexType *dead_indices)
+    {
+        constexpr size_t LANES = 4;
+        const auto dt_v = _mm_set1_ps(dt);
+        const auto kill_v = _mm_set1_ps(kill_height);
+        size_t count = 0;
+        size_t i = 0;
+        for (; i + LANES <= view.size; i += LANES)
+        {
+            const auto z = _mm_loadu_ps(view.z + i);
+            const auto reset = _mm_cmplt_ps(z, kill_v);
+            const auto lifetime =
+                _mm_sub_ps(_mm_loadu_ps(view.lifetime + i), dt_v);
+            const auto expired = _mm_cmple_ps(lifetime, _mm_setzero_ps());
+
+            const auto x = _mm_loadu_ps(view.x + i);
+            const auto y = _mm_loadu_ps(view.y + i);
+            const auto rot = _mm_loadu_ps(view.rotation + i);
+            const auto nx =
+                _mm_add_ps(x, _mm_mul_ps(_mm_loadu_ps(view.vx + i), dt_v));
+            const auto ny =
+                _mm_add_ps(y, _mm_mul_ps(_mm_loadu_ps(view.vy + i), dt_v));
+            const auto nz =
+                _mm_add_ps(z, _mm_mul_ps(_mm_loadu_ps(view.vz + i), dt_v));
+            const auto nrot = _mm_add_ps(
+                rot, _mm_mul_ps(_mm_loadu_ps(view.angular_velocity + i), dt_v));
+
+            _mm_storeu_ps(view.x + i, _mm_blendv_ps(nx, x, reset));
+            _mm_storeu_ps(view.y + i, _mm_blendv_ps(ny, y, reset));
+            _mm_storeu_ps(view.z + i, _mm_blendv_ps(nz, z, reset));
+            _mm_storeu_ps(view.rotation + i, _mm_blendv_ps(nrot, rot, reset));
+            _mm_storeu_ps(view.lifetime + i, lifetime);
+
+            unsigned bits = _mm_movemask_ps(_mm_or_ps(reset, expired));
+            while (bits)
+            {
+                dead_indices[count++] = i + __builtin_ctz(bits);
+                bits &= bits - 1;
+            }
+        }
+        return integrate_scalar(view, i, dt, kill_height, dead_indices,
+                                count);
+    }
+} // namespace pogl::kernels
+
+#endif // x86
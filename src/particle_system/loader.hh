@@ -2,8 +2,10 @@
 
 #include <GL/glew.h>
 #include "RawModel.hh"
+#include "particle_instance.hh"
 #include "utils/gl_check.hh"
-#include <vector>
+#include <memory>
+#include "buffer/stream_buffer.hh"
 #include "shader_program/shader_program.hh"
 
 namespace pogl {
@@ -11,18 +13,19 @@ namespace pogl {
         public:
             Loader() = default;
 
-            RawModel LoadVAO(std::shared_ptr<ShaderProgram> shader, std::vector<float> positions, size_t particle_num);
+            /**
+             * @brief Creates the VAO of the instanced billboards, reading one
+             * ParticleInstance per instance from instances. The returned
+             * model shares the buffer so it outlives the VAO reading it.
+             */
+            RawModel LoadVAO(std::shared_ptr<ShaderProgram> shader, std::shared_ptr<StreamBuffer> instances, size_t particle_num);
 
             GLuint createVAO();
 
-            void createUV(std::vector<GLuint> &VBO_ids);
-            void createTexId(std::vector<GLuint> &VBO_ids);
-
-            void Attribute(const GLchar* s, GLint type, int elt_num);
-
-            void storeData(int VBO_id, std::vector<float> positions, GLenum hint);
-
-            void createVBO(std::vector<GLuint> &VBO_ids);
+            /**
+             * @brief Binds an attribute of ParticleInstance, advancing once per instance.
+             */
+            void InstanceAttribute(const GLchar* s, GLenum type, int elt_num, size_t offset);
 
             void unbindVBO();
             void unbindVAO();
@@ -1,5 +1,4 @@
 #include "particle.hh"
-#include "engine/engine.hh"
 #include "vector3/vector3.hh"
 
 namespace pogl {
@@ -29,17 +28,12 @@ namespace pogl {
         return velocity;
     }
 
-    float Particle::getTexId() const {
-        return tex_id;
-    }
-
-    void Particle::setDistanceFromCamera(Vector3 point) {
-
-        this->distanceFromCamera = (point - position).norm();
+    float Particle::getAngularVelocity() const {
+        return angular_velocity;
     }
 
-    float Particle::getDistanceFromCamera() const {
-        return distanceFromCamera;
+    float Particle::getTexId() const {
+        return tex_id;
     }
 
     void Particle::reset(Vector3 position, Vector3 velocity, float rotation, float angular_velocity, float scale, float tex_id) {
@@ -48,12 +42,6 @@ namespace pogl {
         this->rotation = rotation;
         this->angular_velocity = angular_velocity;
         this->scale = scale;
-        this->distanceFromCamera = 0;
         this->tex_id = tex_id;
     }
-
-    void Particle::Update(double delta) {
-        position += velocity * delta;
-        rotation += angular_velocity * delta;
-    }
 }
\ No newline at end of file
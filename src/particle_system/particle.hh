@@ -13,10 +13,8 @@ namespace pogl {
             Vector3 getVelocity() const;
             float getRotation() const;
             float getScale() const;
+            float getAngularVelocity() const;
             float getTexId() const;
-            void setDistanceFromCamera(Vector3 point);
-            float getDistanceFromCamera() const;
-            void Update(double delta);
             void reset(Vector3 position, Vector3 velocity, float rotation, float angular_velocity, float scale, float tex_id);
 
         private:
@@ -26,6 +24,5 @@ namespace pogl {
             float scale;
             float angular_velocity;
             float rotation;
-            float distanceFromCamera = 0;
     };
 }
\ No newline at end of file
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+#include "utils/half.hh"
+
+namespace pogl
+{
+    /**
+     * @brief Per-flake data read by the particle vertex shader, which expands
+     * it into a camera facing quad.
+     *
+     * The position is stored as half floats relative to an origin given to
+     * the shader with each draw, so precision is best around it. `rotation`
+     * is a fraction of a full turn and `layer` the texture layer. The scale
+     * is shared by every flake of a system and given to the shader as the
+     * `particle_scale` uniform, which leaves the whole byte to the layer.
+     */
+    struct ParticleInstance
+    {
+        static constexpr std::uint32_t MAX_LAYER = 0xff;
+
+        std::uint16_t x;
+        std::uint16_t y;
+        std::uint16_t z;
+        std::uint8_t rotation;
+        std::uint8_t layer;
+
+        /**
+         * @brief Packs a particle at (x, y, z) from the origin, the rotation
+         * is expected in degrees and the texture id is rounded to the nearest
+         * layer.
+         */
+        static ParticleInstance pack(float x, float y, float z, float rotation,
+                                     float tex_id)
+        {
+            const auto turns = rotation / 360.f;
+            const auto packed_rotation = static_cast<std::uint32_t>(
+                                             (turns - std::floor(turns)) * 256.f)
+                & 0xff;
+            const auto packed_layer = static_cast<std::uint32_t>(
+                std::fmin(std::fmax(tex_id + 0.5f, 0.f), MAX_LAYER));
+            return ParticleInstance{
+                float_to_half(x),
+                float_to_half(y),
+                float_to_half(z),
+                static_cast<std::uint8_t>(packed_rotation),
+                static_cast<std::uint8_t>(packed_layer),
+            };
+        }
+    };
+
+    static_assert(sizeof(ParticleInstance) == 8);
+} // namespace pogl
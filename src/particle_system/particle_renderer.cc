@@ -1,90 +1,161 @@
-#include <algorithm>
-
 #include "particle_renderer.hh"
 #include "engine/engine.hh"
 #include "loader.hh"
 #include "RawModel.hh"
 
-namespace pogl {
-    const std::vector<float> ParticleRenderer::VERTICES({-0.5f, 0.5f, -0.5f, -0.5f, 0.5f, 0.5f, 0.5f, -0.5f});
+#include <algorithm>
 
-    ParticleRenderer::ParticleRenderer(std::shared_ptr<ShaderProgram> shader, std::vector<Particle> *particles) {
+namespace pogl {
+    ParticleRenderer::ParticleRenderer(std::shared_ptr<ShaderProgram> shader, const ParticleStorage *particles) {
         Loader loader;
-        quad = loader.LoadVAO(shader, VERTICES, particles->size());
+        // everything is sized from the pool capacity, only the live range
+        // is sorted, uploaded and drawn
+        const auto capacity = particles->capacity();
+        instances = std::make_shared<StreamBuffer>(GL_ARRAY_BUFFER, capacity * sizeof(ParticleInstance));
+        quad = loader.LoadVAO(shader, instances, capacity);
         this->shader = shader;
         this->particles = particles;
-        this->vertexPositionData = std::vector<GLfloat> (12*particles->size());
-        this->vertexTexIdData = std::vector<GLfloat>(4*particles->size());
-        instanceIndices = std::vector<GLint>(particles->size());
-        instanceDataCounts = std::vector<GLsizei>(particles->size());
-        for(size_t i = 0; i < instanceIndices.size(); i++) {
-            instanceIndices[i] = i*4;
-            instanceDataCounts[i] = 4;
+        this->transparencyTarget = nullptr;
+        this->jobs = Engine::instance().job_system;
+        this->preparing = std::make_shared<JobSystem::Counter>();
+        for (auto &snapshot : snapshots) {
+            snapshot.size = 0;
+            for (auto *attribute : {&snapshot.x, &snapshot.y, &snapshot.z, &snapshot.rotation, &snapshot.tex_id}) {
+                attribute->resize(capacity);
+            }
         }
+        this->snapshotIndex = 0;
+        this->preparedCount = 0;
+        this->preparedOrigin = Vector3::zero();
+        this->visibleCount = 0;
+        sortedParticles.reserve(capacity);
+        visibleIndices = std::vector<Frustum::IndexType>(capacity);
+    }
+
+    ParticleRenderer::~ParticleRenderer() {
+        waitPrepared();
     }
 
     void ParticleRenderer::clean() {
-        glDeleteBuffers(quad.getVBOs().size(), quad.getVBOs().data());
+        waitPrepared();
         GLuint VAO = quad.getVAO();
         glDeleteVertexArrays(1, &VAO);              // destroy the particles from the shader
+        // the model shares the instance buffer, both references go
+        quad = RawModel();
+        instances.reset();
     }
 
-    void ParticleRenderer::genMesh() {
-        const auto y_axis = -Engine::instance().main_camera->get_forward();
-        const auto x_axis = Vector3::up().cross(y_axis).normalized();
-        const auto z_axis = y_axis.cross(x_axis).normalized();
-        const auto rotation_transform = Matrix4::basis_change(x_axis, y_axis, z_axis)
-            * Matrix4::scale(0.225);
-
-        for(size_t i = 0; i < particles->size(); i++) {
-            const auto &p = particles->at(i);
-            auto center = p.getPosition();
-            for(size_t j = 0; j < 4; j++) {
-                const auto vert_pos = (rotation_transform * Matrix4::rotate(p.getRotation(), "y") * Vector4(VERTICES[j * 2], 0, VERTICES[j * 2 + 1], 1)).to_spatial() + center;
-                vertexPositionData[i*12+j*3] = vert_pos.x;
-                vertexPositionData[i*12+j*3+1] = vert_pos.y;
-                vertexPositionData[i*12+j*3+2] = vert_pos.z;
-                vertexTexIdData[i*4+j] = p.getTexId();
-            }
+    void ParticleRenderer::setTransparencyTarget(std::shared_ptr<OitFramebuffer> target) {
+        // the frame in flight is ordered for the current mode
+        waitPrepared();
+        this->transparencyTarget = target;
+    }
+
+    void ParticleRenderer::setScale(float scale) {
+        auto particleScale = shader->uniform("particle_scale");
+        if (particleScale) {
+            particleScale->set_float(scale);
         }
-        
-        glBindBuffer(GL_ARRAY_BUFFER, quad.getVBOs()[0]);
-        CHECK_GL_ERROR();
-        glBufferData(GL_ARRAY_BUFFER, vertexPositionData.size() * sizeof(GLfloat), vertexPositionData.data(), GL_DYNAMIC_DRAW);
-        CHECK_GL_ERROR();
-        glBindBuffer(GL_ARRAY_BUFFER, quad.getVBOs()[2]);
-        CHECK_GL_ERROR();
-        glBufferData(GL_ARRAY_BUFFER, vertexTexIdData.size() * sizeof(GLfloat), vertexTexIdData.data(), GL_DYNAMIC_DRAW);
-        CHECK_GL_ERROR();
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        CHECK_GL_ERROR();
     }
 
+    void ParticleRenderer::waitPrepared() {
+        if (preparing) {
+            jobs->wait(*preparing);
+        }
+    }
 
-    bool CompareDistance(Particle A, Particle B);
+    void ParticleRenderer::takeSnapshot(Snapshot &snapshot) const {
+        const auto view = particles->view();
+        snapshot.size = view.size;
+        std::copy_n(view.x, view.size, snapshot.x.data());
+        std::copy_n(view.y, view.size, snapshot.y.data());
+        std::copy_n(view.z, view.size, snapshot.z.data());
+        std::copy_n(view.rotation, view.size, snapshot.rotation.data());
+        std::copy_n(view.tex_id, view.size, snapshot.tex_id.data());
+    }
 
-    void ParticleRenderer::sort_particles() {
-        const Vector3 cameraPositon = -Engine::instance().main_camera->get_position();
-        for (auto &particle : *particles) {
-           particle.setDistanceFromCamera(cameraPositon); 
+    void ParticleRenderer::genMesh(const Snapshot &snapshot, const Vector3 &origin, ParticleInstance *instanceData) {
+        // the quads themselves are built by the vertex shader, the sorted
+        // instances are written straight into the mapped region
+        const bool sorted = transparencyTarget == nullptr;
+        for(size_t i = 0; i < visibleCount; i++) {
+            const auto index = sorted ? sortedParticles[i].index : visibleIndices[i];
+            instanceData[i] = ParticleInstance::pack(snapshot.x[index] - origin.x, snapshot.y[index] - origin.y, snapshot.z[index] - origin.z, snapshot.rotation[index], snapshot.tex_id[index]);
         }
+    }
+
 
-        std::sort(particles->begin(), particles->end(), CompareDistance);
+    void ParticleRenderer::cull_particles(const Snapshot &snapshot, const Frustum &frustum) {
+        visibleCount = frustum.cull_spheres(snapshot.x.data(), snapshot.y.data(), snapshot.z.data(), snapshot.size, CULLING_RADIUS, visibleIndices.data());
     }
 
-    bool CompareDistance(Particle A, Particle B) {
-        return A.getDistanceFromCamera() < B.getDistanceFromCamera();
+    void ParticleRenderer::sort_particles(const Snapshot &snapshot, const Vector3 &origin) {
+        sortedParticles.resize(visibleCount);
+        // squared distances sort the same way as distances, without the sqrt
+        for (size_t i = 0; i < visibleCount; i++) {
+            const auto index = visibleIndices[i];
+            const auto dx = snapshot.x[index] - origin.x;
+            const auto dy = snapshot.y[index] - origin.y;
+            const auto dz = snapshot.z[index] - origin.z;
+            sortedParticles[i] = KeyIndexPair{far_to_near_key(dx * dx + dy * dy + dz * dz), index};
+        }
+
+        sorter.sort(sortedParticles);
+    }
+
+    void ParticleRenderer::prepare(const Snapshot &snapshot, const Frustum &frustum, const Vector3 &sortOrigin, const Vector3 &instanceOrigin, ParticleInstance *instanceData) {
+        cull_particles(snapshot, frustum);
+        // weighted blending is commutative, the order of the flakes only
+        // matters with alpha blending
+        if (!transparencyTarget) {
+            sort_particles(snapshot, sortOrigin);
+        }
+        genMesh(snapshot, instanceOrigin, instanceData);
+        preparedCount = visibleCount;
+        preparedOrigin = instanceOrigin;
     }
 
     void ParticleRenderer::draw() {
-        shader->use();
-        glBindVertexArray(quad.getVAO());
-        CHECK_GL_ERROR();
-        sort_particles();
-        genMesh();
-        glMultiDrawArrays(GL_TRIANGLE_STRIP, instanceIndices.data(), instanceDataCounts.data(), instanceIndices.size());
-        CHECK_GL_ERROR();
-        glBindVertexArray(0);
-        CHECK_GL_ERROR();
+        // taken before waiting, the previous snapshot may still be read
+        auto &snapshot = snapshots[snapshotIndex];
+        snapshotIndex = (snapshotIndex + 1) % snapshots.size();
+        takeSnapshot(snapshot);
+        waitPrepared();
+
+        if (preparedCount > 0) {
+            auto instanceOrigin = shader->uniform("instance_origin");
+            if (instanceOrigin) {
+                instanceOrigin->set_vec3(preparedOrigin);
+            }
+            shader->use();
+            glBindVertexArray(quad.getVAO());
+            CHECK_GL_ERROR();
+            if (transparencyTarget) {
+                transparencyTarget->begin();
+            }
+            // instanced attributes start at the region prepared last frame
+            const auto baseInstance = instances->region_index() * particles->capacity();
+            glDrawArraysInstancedBaseInstance(GL_TRIANGLE_STRIP, 0, 4, preparedCount, baseInstance);
+            CHECK_GL_ERROR();
+            instances->end_region();
+            if (transparencyTarget) {
+                transparencyTarget->end();
+            }
+            glBindVertexArray(0);
+            CHECK_GL_ERROR();
+        }
+
+        // fences are waited on by the GL thread, the worker only writes
+        // into the mapped region
+        auto *instanceData = static_cast<ParticleInstance*>(instances->begin_region());
+        const auto &camera = Engine::instance().main_camera;
+        const auto frustum = camera->get_frustum();
+        // flakes are blended far to near from the eye, and half float
+        // positions are most precise close to it
+        const Vector3 sortOrigin = camera->get_position();
+        const Vector3 instanceOrigin = camera->get_position();
+        jobs->submit([this, &snapshot, frustum, sortOrigin, instanceOrigin, instanceData]() {
+            prepare(snapshot, frustum, sortOrigin, instanceOrigin, instanceData);
+        }, *preparing);
     }
-}
\ No newline at end of file
+}
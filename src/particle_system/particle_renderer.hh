@@ -1,46 +1,135 @@
 #pragma once
 
 #include <GL/glew.h>
+#include <array>
+#include <memory>
 #include <vector>
-#include "particle.hh"
+#include "buffer/stream_buffer.hh"
+#include "framebuffer/oit_framebuffer.hh"
+#include "particle_instance.hh"
+#include "particle_storage.hh"
 #include "shader_program/shader_program.hh"
 #include "matrix4/matrix4.hh"
 #include "camera/camera.hh"
+#include "jobs/job_system.hh"
 #include "RawModel.hh"
+#include "utils/aligned_allocator.hh"
+#include "utils/radix_sort.hh"
 
 namespace pogl {
     class ParticleRenderer
     {
         public:
-            static const std::vector<float> VERTICES;
+            /**
+             * @brief Radius of the sphere bounding a billboard, half the
+             * diagonal of a 0.225 wide quad with some margin for scale.
+             */
+            static constexpr float CULLING_RADIUS = 0.2;
+
+            /**
+             * @brief Copy of the attributes the billboards are built from,
+             * read by the worker preparing a frame while the simulation
+             * updates the pool.
+             */
+            struct Snapshot
+            {
+                size_t size;
+                AlignedVector<float> x;
+                AlignedVector<float> y;
+                AlignedVector<float> z;
+                AlignedVector<float> rotation;
+                AlignedVector<float> tex_id;
+            };
 
             ParticleRenderer() = default;
 
             ParticleRenderer(ParticleRenderer& PR) = default;
 
-            ParticleRenderer(std::shared_ptr<ShaderProgram> shader, std::vector<Particle> *particles);
+            ParticleRenderer(std::shared_ptr<ShaderProgram> shader, const ParticleStorage *particles);
+
+            /**
+             * @brief Waits for the frame being prepared, which writes into
+             * the instance buffer.
+             */
+            ~ParticleRenderer();
+
+            /**
+             * @brief Draws into target with weighted blended transparency,
+             * the visible particles are then drawn in pool order and never
+             * sorted. A null target goes back to sorted alpha blending.
+             */
+            void setTransparencyTarget(std::shared_ptr<OitFramebuffer> target);
 
-            ~ParticleRenderer() = default;
+            /**
+             * @brief Sets the scale of every billboard, instances only carry
+             * their texture layer.
+             */
+            void setScale(float scale);
 
             /**
-             * @brief Re-orient the particles to the view of the camera.
+             * @brief Packs the ordered particles of snapshot into
+             * instanceData relative to origin, the vertex shader orients the
+             * quads.
              */
-            void updateModelViewMatrix(Vector3 position, float rotation, float scale, Matrix4 ViewMatrix);
+            void genMesh(const Snapshot &snapshot, const Vector3 &origin, ParticleInstance *instanceData);
 
-            void genMesh();
+            /**
+             * @brief Draws the instances prepared during the previous frame,
+             * then snapshots the particles and prepares the next frame on
+             * the job system. What is drawn lags one frame behind the
+             * simulation, in exchange culling, sorting and packing never
+             * stall the GL thread.
+             */
             void draw();
 
             void clean();
 
-            void sort_particles();
+            /**
+             * @brief Gathers the indices of the particles of snapshot in
+             * frustum, the only ones sorted and drawn.
+             */
+            void cull_particles(const Snapshot &snapshot, const Frustum &frustum);
+
+            /**
+             * @brief Orders the visible particle indices from the farthest
+             * to the nearest to origin, the particles themselves are left
+             * in place.
+             */
+            void sort_particles(const Snapshot &snapshot, const Vector3 &origin);
 
         private:
+            void takeSnapshot(Snapshot &snapshot) const;
+
+            /**
+             * @brief Job body: culls, sorts from sortOrigin unless blending
+             * is order independent, and packs snapshot into instanceData
+             * relative to instanceOrigin.
+             */
+            void prepare(const Snapshot &snapshot, const Frustum &frustum, const Vector3 &sortOrigin, const Vector3 &instanceOrigin, ParticleInstance *instanceData);
+
+            /**
+             * @brief Blocks until the frame being prepared is ready
+             */
+            void waitPrepared();
+
             RawModel quad;
-            std::vector<Particle> *particles;
+            const ParticleStorage *particles;
             std::shared_ptr<ShaderProgram> shader;
-            std::vector<GLfloat> vertexPositionData;
-            std::vector<GLint> instanceIndices;
-            std::vector<GLsizei> instanceDataCounts;
-            std::vector<GLfloat> vertexTexIdData;
+            std::shared_ptr<StreamBuffer> instances;
+            std::shared_ptr<OitFramebuffer> transparencyTarget;
+            std::shared_ptr<JobSystem> jobs;
+            std::shared_ptr<JobSystem::Counter> preparing;
+            // the snapshot of the next frame is taken while the previous
+            // one may still be read
+            std::array<Snapshot, 2> snapshots;
+            size_t snapshotIndex;
+            // instances written in the current region of the buffer, and
+            // the origin of their positions
+            size_t preparedCount;
+            Vector3 preparedOrigin;
+            std::vector<Frustum::IndexType> visibleIndices;
+            size_t visibleCount;
+            RadixSorter::BufferType sortedParticles;
+            RadixSorter sorter;
     };
 }
\ No newline at end of file
@@ -0,0 +1,149 @@
+#include "particle_storage.hh"
+
+namespace pogl
+{
+    using SizeType = ParticleStorage::SizeType;
+
+    ParticleStorage::ParticleStorage(SizeType capacity)
+        : _size(0)
+    {
+        for (auto array : arrays())
+        {
+            array->resize(capacity);
+        }
+        _scratch.resize(capacity);
+    }
+
+    SizeType ParticleStorage::size() const
+    {
+        return _size;
+    }
+
+    SizeType ParticleStorage::capacity() const
+    {
+        return _x.size();
+    }
+
+    bool ParticleStorage::empty() const
+    {
+        return _size == 0;
+    }
+
+    bool ParticleStorage::full() const
+    {
+        return _size == capacity();
+    }
+
+    void ParticleStorage::clear()
+    {
+        _size = 0;
+    }
+
+    bool ParticleStorage::spawn(const Particle &particle, float lifetime)
+    {
+        if (full())
+        {
+            return false;
+        }
+        const auto index = _size++;
+        set(index, particle);
+        _lifetime[index] = lifetime;
+        return true;
+    }
+
+    void ParticleStorage::kill(SizeType index)
+    {
+        const auto last = --_size;
+        if (index == last)
+        {
+            return;
+        }
+        for (auto array : arrays())
+        {
+            (*array)[index] = (*array)[last];
+        }
+    }
+
+    Particle ParticleStorage::get(SizeType index) const
+    {
+        return Particle(Vector3(_x[index], _y[index], _z[index]),
+                        Vector3(_vx[index], _vy[index], _vz[index]),
+                        _rotation[index], _angular_velocity[index],
+                        _scale[index], _tex_id[index]);
+    }
+
+    void ParticleStorage::set(SizeType index, const Particle &particle)
+    {
+        const auto position = particle.getPosition();
+        const auto velocity = particle.getVelocity();
+        _x[index] = position.x;
+        _y[index] = position.y;
+        _z[index] = position.z;
+        _vx[index] = velocity.x;
+        _vy[index] = velocity.y;
+        _vz[index] = velocity.z;
+        _rotation[index] = particle.getRotation();
+        _angular_velocity[index] = particle.getAngularVelocity();
+        _scale[index] = particle.getScale();
+        _tex_id[index] = particle.getTexId();
+    }
+
+    void ParticleStorage::reorder(std::span<const std::uint32_t> order)
+    {
+        for (auto array : arrays())
+        {
+            for (SizeType i = 0; i < _size; ++i)
+            {
+                _scratch[i] = (*array)[order[i]];
+            }
+            array->swap(_scratch);
+        }
+    }
+
+    ParticleView ParticleStorage::view()
+    {
+        return ParticleView{
+            size(),
+            _x.data(),
+            _y.data(),
+            _z.data(),
+            _vx.data(),
+            _vy.data(),
+            _vz.data(),
+            _rotation.data(),
+            _angular_velocity.data(),
+            _scale.data(),
+            _tex_id.data(),
+            _lifetime.data(),
+        };
+    }
+
+    ConstParticleView ParticleStorage::view() const
+    {
+        return ConstParticleView{
+            size(),
+            _x.data(),
+            _y.data(),
+            _z.data(),
+            _vx.data(),
+            _vy.data(),
+            _vz.data(),
+            _rotation.data(),
+            _angular_velocity.data(),
+            _scale.data(),
+            _tex_id.data(),
+            _lifetime.data(),
+        };
+    }
+
+    std::array<ParticleStorage::ArrayType *, ParticleStorage::ARRAY_COUNT>
+    ParticleStorage::arrays()
+    {
+        return { &_x,        &_y,
+                 &_z,        &_vx,
+                 &_vy,       &_vz,
+                 &_rotation, &_angular_velocity,
+                 &_scale,    &_tex_id,
+                 &_lifetime };
+    }
+} // namespace pogl
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "particle.hh"
+#include "utils/aligned_allocator.hh"
+#include "vector3/vector3.hh"
+
+namespace pogl
+{
+    /**
+     * @brief Non owning structure-of-arrays window over particle attributes.
+     * Every pointer addresses `size` consecutive elements, index `i` of each
+     * array describing the same particle.
+     *
+     * @tparam ValueType `float` for a mutable view, `const float` otherwise
+     */
+    template <typename ValueType>
+    struct BasicParticleView
+    {
+        using SizeType = std::size_t;
+
+        SizeType size;
+        ValueType *x;
+        ValueType *y;
+        ValueType *z;
+        ValueType *vx;
+        ValueType *vy;
+        ValueType *vz;
+        ValueType *rotation;
+        ValueType *angular_velocity;
+        ValueType *scale;
+        ValueType *tex_id; // shader needs a float
+        ValueType *lifetime; // remaining seconds
+
+        inline Vector3 position(SizeType i) const
+        {
+            return Vector3(x[i], y[i], z[i]);
+        }
+
+        inline Vector3 velocity(SizeType i) const
+        {
+            return Vector3(vx[i], vy[i], vz[i]);
+        }
+
+        /**
+         * @brief Narrows the view to the particles in [begin; end)
+         *
+         * @param begin first particle of the sub view
+         * @param end one past the last particle of the sub view
+         * @return BasicParticleView
+         */
+        inline BasicParticleView subview(SizeType begin, SizeType end) const
+        {
+            return BasicParticleView{
+                end - begin,
+                x + begin,
+                y + begin,
+                z + begin,
+                vx + begin,
+                vy + begin,
+                vz + begin,
+                rotation + begin,
+                angular_velocity + begin,
+                scale + begin,
+                tex_id + begin,
+                lifetime + begin,
+            };
+        }
+    };
+
+    using ParticleView = BasicParticleView<float>;
+    using ConstParticleView = BasicParticleView<const float>;
+
+    /**
+     * @brief Fixed capacity pool owning the particles attributes as separate
+     * aligned arrays, so that passes only stream the attributes they actually
+     * read. Live particles are kept packed in [0; size()), spawning and
+     * killing are O(1) and never reallocate.
+     */
+    class ParticleStorage
+    {
+    public:
+        using SizeType = std::size_t;
+        using ArrayType = AlignedVector<float>;
+
+        explicit ParticleStorage(SizeType capacity = 0);
+
+        /**
+         * @brief Number of live particles
+         *
+         * @return SizeType
+         */
+        SizeType size() const;
+        SizeType capacity() const;
+        bool empty() const;
+        bool full() const;
+
+        /**
+         * @brief Kills every particle
+         */
+        void clear();
+
+        /**
+         * @brief Appends a particle after the live ones
+         *
+         * @param particle
+         * @param lifetime seconds before the particle dies
+         * @return true when the particle was spawned, false if the pool is
+         * full
+         */
+        bool spawn(const Particle &particle, float lifetime);
+
+        /**
+         * @brief Kills the particle at index by moving the last live particle
+         * in its place. Indices above index are left untouched, so killing
+         * in decreasing index order is safe.
+         *
+         * @param index
+         */
+        void kill(SizeType index);
+
+        /**
+         * @brief Gathers the attributes of a particle into a Particle value
+         *
+         * @param index
+         * @return Particle
+         */
+        Particle get(SizeType index) const;
+
+        /**
+         * @brief Scatters the attributes of particle at index, its lifetime
+         * is kept
+         *
+         * @param index
+         * @param particle
+         */
+        void set(SizeType index, const Particle &particle);
+
+        /**
+         * @brief Moves the live particles into a new order, particle
+         * order[i] ends up at index i.
+         *
+         * @param order permutation of [0; size())
+         */
+        void reorder(std::span<const std::uint32_t> order);
+
+        /**
+         * @brief View over the live particles
+         */
+        ParticleView view();
+        ConstParticleView view() const;
+
+    private:
+        static constexpr SizeType ARRAY_COUNT = 11;
+        std::array<ArrayType *, ARRAY_COUNT> arrays();
+
+        SizeType _size;
+        ArrayType _x;
+        ArrayType _y;
+        ArrayType _z;
+        ArrayType _vx;
+        ArrayType _vy;
+        ArrayType _vz;
+        ArrayType _rotation;
+        ArrayType _angular_velocity;
+        ArrayType _scale;
+        ArrayType _tex_id;
+        ArrayType _lifetime;
+        // destination of reorder, swapped with each array in turn
+        ArrayType _scratch;
+    };
+} // namespace pogl
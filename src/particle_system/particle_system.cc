@@ -1,35 +1,121 @@
 #include "particle_system.hh"
 
-#include "utils/random.hh"
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+#include "engine/engine.hh"
+#include "utils/log.hh"
 
 namespace pogl {
     constexpr Vector3 center = Vector3(0,0,10);
     constexpr float MAX_ANGULAR_VELOCITY = 120;
 
-    ParticleSystem::ParticleSystem(std::shared_ptr<ShaderProgram> shader, size_t textureCount)
+    ParticleSystem::ParticleSystem(std::shared_ptr<ShaderProgram> shader, size_t textureCount, size_t capacity)
+        : particles(capacity)
     {
-        std::vector<Particle> particles;
         this->shader = shader;
         this->respawnHeight = -1.1; // hardcode for now, parametrize later
-        this->particles = particles;
         this->textureCount = (float)textureCount;
+        this->emissionRate = DEFAULT_EMISSION_RATE;
+        this->emissionAccumulator = 0;
+        this->lifetime = DEFAULT_LIFETIME;
+        this->followedCamera = nullptr;
+        this->ground = nullptr;
+        this->wind = nullptr;
+        this->reorderInterval = 0;
+        this->randomSeed = global_seed();
+        this->frameIndex = 0;
         generate_particles(Vector3(0,0,6), 300);
         ParticleRenderer PR(shader, &this->particles);
         this->renderer = PR;
+        this->renderer.setScale(FLAKE_SCALE);
     }
 
-    bool ParticleSystem::shouldParticleReset(const Particle &particle)
-    {
-        return particle.getPosition().z < respawnHeight;
+    void ParticleSystem::update(double delta) {
+        const auto view = particles.view();
+        const auto chunkCount = (view.size + CHUNK_SIZE - 1) / CHUNK_SIZE;
+        deadIndices.resize(view.size);
+        deadCounts.assign(chunkCount, 0);
+        if (ground) {
+            landedIndices.resize(view.size);
+            while (accumulators.size() < chunkCount) {
+                accumulators.push_back(ground->make_accumulator());
+            }
+        }
+
+        // particles following the camera never fall out of the world, they
+        // wrap around the faces of the box instead
+        const bool following = followedCamera != nullptr;
+        const auto killHeight = following ? -std::numeric_limits<float>::infinity() : respawnHeight;
+        const auto boxMin = following ? followedCamera->get_position() - followHalfExtents : Vector3::zero();
+        const auto boxSize = followHalfExtents * 2;
+
+        // each chunk writes the indices of its dead particles in its own
+        // slice of deadIndices, starting at the chunk's first particle
+        Engine::instance().job_system->parallel_for(view.size, CHUNK_SIZE, [&](size_t chunk, size_t begin, size_t end) {
+            const auto chunkView = view.subview(begin, end);
+            if (ground) {
+                // landed on the previous step: a zero lifetime makes the
+                // integration kill them along with the others
+                const auto landedCount = ground->land_particles(chunkView, landedIndices.data() + begin, accumulators[chunk]);
+                for (size_t i = 0; i < landedCount; i++) {
+                    const auto index = landedIndices[begin + i];
+                    if (following) {
+                        chunkView.z[index] += boxSize.z;
+                    } else {
+                        chunkView.lifetime[index] = 0;
+                    }
+                }
+            }
+            deadCounts[chunk] = integrate_particles(chunkView, delta, killHeight, deadIndices.data() + begin);
+            if (wind) {
+                wind->advect(chunkView, delta);
+            }
+            if (following) {
+                wrap_particles(chunkView, boxMin, boxSize);
+            }
+        });
+
+        // kill in decreasing index order, so that swap-remove only ever moves
+        // live particles into the freed slots
+        for (size_t chunk = chunkCount; chunk-- > 0;) {
+            const auto begin = chunk * CHUNK_SIZE;
+            for (size_t i = deadCounts[chunk]; i-- > 0;) {
+                particles.kill(begin + deadIndices[begin + i]);
+            }
+        }
+
+        if (ground) {
+            ground->deposit(std::span(accumulators.data(), chunkCount));
+        }
+
+        if (!following) {
+            emit(delta);
+        }
+
+        if (spatialGrid) {
+            auto &jobs = *Engine::instance().job_system;
+            spatialGrid->rebuild(std::as_const(particles).view(), jobs);
+            if (reorderInterval > 0 && frameIndex % reorderInterval == 0) {
+                particles.reorder(spatialGrid->permutation());
+                spatialGrid->reset_permutation(jobs);
+            }
+        }
+        frameIndex++;
     }
 
-    void ParticleSystem::update(double delta) {
-        for (auto &particle : particles) {
-            if(shouldParticleReset(particle))
-                particleReset(particle, center);
-            else
-                particle.Update(delta);
+    void ParticleSystem::emit(double delta) {
+        emissionAccumulator += emissionRate * delta;
+        const auto wanted = (size_t)emissionAccumulator;
+        emissionAccumulator -= wanted;
+        const auto count = std::min(wanted, particles.capacity() - particles.size());
+        if (count == 0) {
+            return;
         }
+        // stream 0 is used by generate_particles
+        RandomBatch random(randomSeed, frameIndex + 1);
+        spawnParticles(count, center + Vector3(-3, -3, 0), center + Vector3(3, 3, 0), lifetime, random);
     }
 
     void ParticleSystem::clean() {
@@ -37,34 +123,108 @@ namespace pogl {
     }
     
     void ParticleSystem::addParticle(Particle particle) {
-        particles.push_back(particle);
+        particles.spawn(particle, lifetime);
     }
         
     void ParticleSystem::generate_particles(Vector3 center, float number) {
-        for(float i = 0; i < number; i++) {
-            const auto px = center.x + float_rand_range(-3, 3);
-            const auto py = center.y + float_rand_range(-3, 3);
-            const auto pz = float_rand_range(respawnHeight, center.z);
-            const auto position = Vector3(px, py, pz);
-            Vector3 velocity(float_rand_range(-0.5, 0.5), float_rand_range(-0.5, 0.5), float_rand_range(-1, -2));
-
-            const auto texId = float_rand_range(0, textureCount);
-            const auto angle = float_rand_range(0,360);
-            const auto angular_velocity = float_rand_range(-MAX_ANGULAR_VELOCITY, MAX_ANGULAR_VELOCITY);
-            Particle newParticle = Particle(position, velocity, angle, angular_velocity, 1, texId);
-            addParticle(newParticle);
+        RandomBatch random(randomSeed);
+        const auto boxMin = Vector3(center.x - 3, center.y - 3, respawnHeight);
+        spawnParticles(number, boxMin, center + Vector3(3, 3, 0), lifetime, random);
+    }
+
+    void ParticleSystem::followCamera(std::shared_ptr<Camera> camera, Vector3 halfExtents, size_t count) {
+        followedCamera = camera;
+        followHalfExtents = halfExtents;
+        emissionAccumulator = 0;
+        particles.clear();
+        // infinite lifetimes, particles are only recycled by wrapping
+        const auto position = camera->get_position();
+        RandomBatch random(randomSeed, frameIndex + 1);
+        spawnParticles(count, position - halfExtents, position + halfExtents, std::numeric_limits<float>::infinity(), random);
+    }
+
+    void ParticleSystem::stopFollowingCamera() {
+        followedCamera = nullptr;
+        const auto view = particles.view();
+        std::fill(view.lifetime, view.lifetime + view.size, lifetime);
+    }
+
+    void ParticleSystem::setEmissionRate(float particlesPerSecond) {
+        emissionRate = std::max(particlesPerSecond, 0.f);
+    }
+
+    float ParticleSystem::getEmissionRate() const {
+        return emissionRate;
+    }
+
+    void ParticleSystem::setLifetime(float seconds) {
+        lifetime = seconds;
+    }
+
+    float ParticleSystem::getLifetime() const {
+        return lifetime;
+    }
+
+    size_t ParticleSystem::getParticleCount() const {
+        return particles.size();
+    }
+
+    void ParticleSystem::setTransparencyTarget(std::shared_ptr<OitFramebuffer> target) {
+        renderer.setTransparencyTarget(target);
+    }
+
+    void ParticleSystem::setGround(std::shared_ptr<GroundObject> ground) {
+        accumulators.clear();
+        if (ground && !ground->receives_particles()) {
+            std::cerr << LOG_WARNING << "ground does not accumulate deposited snow, flakes will not land on it" << std::endl;
+            ground = nullptr;
         }
+        this->ground = ground;
+    }
+
+    void ParticleSystem::setWind(std::shared_ptr<const WindField> wind) {
+        this->wind = wind;
+    }
+
+    void ParticleSystem::setSpatialGrid(float cellSize, size_t reorderInterval) {
+        this->spatialGrid = cellSize > 0 ? std::make_unique<SpatialGrid>(cellSize) : nullptr;
+        this->reorderInterval = reorderInterval;
     }
 
-    void ParticleSystem::particleReset(Particle& particle, Vector3 center) {
-        const auto px = center.x + float_rand_range(-3,3);
-        const auto py = center.x + float_rand_range(-3,3);
-        const auto position = Vector3(px, py, center.z);
-        Vector3 velocity(float_rand_range(-0.5, 0.5), float_rand_range(-0.5, 0.5), float_rand_range(-1, -2));
-        const auto texId = float_rand_range(0, textureCount);
-        const auto angle = float_rand_range(0,360);
-        const auto angular_velocity = float_rand_range(-MAX_ANGULAR_VELOCITY, MAX_ANGULAR_VELOCITY);
-        particle.reset(position, velocity, angle, angular_velocity, particle.getScale(), texId);
+    const SpatialGrid *ParticleSystem::getSpatialGrid() const {
+        return spatialGrid.get();
+    }
+
+    size_t ParticleSystem::getCapacity() const {
+        return particles.capacity();
+    }
+
+    void ParticleSystem::spawnParticles(size_t count, Vector3 boxMin, Vector3 boxMax, float particleLifetime, RandomBatch &random) {
+        count = std::min(count, particles.capacity() - particles.size());
+        std::vector<float> values(9 * count);
+        auto *px = values.data();
+        auto *py = px + count;
+        auto *pz = py + count;
+        auto *vx = pz + count;
+        auto *vy = vx + count;
+        auto *vz = vy + count;
+        auto *texId = vz + count;
+        auto *angle = texId + count;
+        auto *angularVelocity = angle + count;
+        random.fill(px, count, boxMin.x, boxMax.x);
+        random.fill(py, count, boxMin.y, boxMax.y);
+        random.fill(pz, count, boxMin.z, boxMax.z);
+        random.fill(vx, count, -0.5, 0.5);
+        random.fill(vy, count, -0.5, 0.5);
+        random.fill(vz, count, -2, -1);
+        random.fill(texId, count, 0, textureCount);
+        random.fill(angle, count, 0, 360);
+        random.fill(angularVelocity, count, -MAX_ANGULAR_VELOCITY, MAX_ANGULAR_VELOCITY);
+        for(size_t i = 0; i < count; i++) {
+            const auto position = Vector3(px[i], py[i], pz[i]);
+            const auto velocity = Vector3(vx[i], vy[i], vz[i]);
+            particles.spawn(Particle(position, velocity, angle[i], angularVelocity[i], FLAKE_SCALE, texId[i]), particleLifetime);
+        }
     }
 
     void ParticleSystem::draw() {
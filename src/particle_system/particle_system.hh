@@ -1,38 +1,167 @@
 #pragma once
 
 #include <GL/glew.h>
+#include <cstdint>
+#include <memory>
 #include <vector>
+#include "integration.hh"
 #include "shader_program/shader_program.hh"
 #include "matrix4/matrix4.hh"
 #include "camera/camera.hh"
+#include "object/ground_object.hh"
 #include "particle_renderer.hh"
+#include "particle_storage.hh"
 #include "properties/drawable.hh"
+#include "spatial_grid.hh"
+#include "utils/rng.hh"
+#include "wind_field.hh"
 
 namespace pogl {
     class ParticleSystem : public Updateable, public Drawable
     {
         public:
-            ParticleSystem(std::shared_ptr<ShaderProgram> shader, size_t textureCount);
+            /**
+             * @brief Number of particles integrated by one job, chunks are
+             * updated in parallel on the engine's job system.
+             */
+            static constexpr size_t CHUNK_SIZE = 16384;
+
+            /**
+             * @brief Maximum number of live particles by default
+             */
+            static constexpr size_t DEFAULT_CAPACITY = 1024;
+            /**
+             * @brief Particles spawned per second by default, about 300 live
+             * flakes once the snowfall is steady
+             */
+            static constexpr float DEFAULT_EMISSION_RATE = 40;
+            /**
+             * @brief Seconds a particle lives if it does not reach the ground
+             */
+            static constexpr float DEFAULT_LIFETIME = 15;
+            /**
+             * @brief Scale of every spawned flake. Billboards are drawn at
+             * this scale whatever the scale of the particles added.
+             */
+            static constexpr float FLAKE_SCALE = 1;
+
+            ParticleSystem(std::shared_ptr<ShaderProgram> shader, size_t textureCount, size_t capacity = DEFAULT_CAPACITY);
 
             virtual ~ParticleSystem() = default;
 
             void update(double delta);
             void clean();
+
+            /**
+             * @brief Spawns particle with the current lifetime, dropped when
+             * the pool is full.
+             */
             void addParticle(Particle particle);
 
             void generate_particles(Vector3 center, float number);
 
-            void particleReset(Particle& particle, Vector3 center);
+            /**
+             * @brief Number of particles spawned per second, can be changed at
+             * any time without reallocating anything.
+             */
+            void setEmissionRate(float particlesPerSecond);
+            float getEmissionRate() const;
+
+            /**
+             * @brief Lifetime in seconds given to the particles spawned from now on
+             */
+            void setLifetime(float seconds);
+            float getLifetime() const;
+
+            /**
+             * @brief Attaches the emission volume to camera: count particles
+             * fill a box of halfExtents around it and wrap to the opposite
+             * face when they leave it instead of dying, so the cost of the
+             * snowfall does not depend on the size of the world. Emission
+             * stops while following.
+             */
+            void followCamera(std::shared_ptr<Camera> camera, Vector3 halfExtents, size_t count);
+
+            /**
+             * @brief Back to emission above center, the particles of the
+             * camera box fall and die normally.
+             */
+            void stopFollowingCamera();
+
+            /**
+             * @brief Draws the flakes with weighted blended transparency in
+             * target instead of sorting them, null to sort again.
+             */
+            void setTransparencyTarget(std::shared_ptr<OitFramebuffer> target);
 
-            bool shouldParticleReset(const Particle &particle);
+            /**
+             * @brief Flakes reaching ground deposit snow on it. They die in
+             * emission mode and start again from the top of the box when
+             * following a camera. Only grounds receiving particles are
+             * supported, null stops the coupling.
+             */
+            void setGround(std::shared_ptr<GroundObject> ground);
+
+            /**
+             * @brief Flakes are carried by wind on top of their own velocity,
+             * null for still air. The field is updated by its owner.
+             */
+            void setWind(std::shared_ptr<const WindField> wind);
+
+            /**
+             * @brief Rebuilds a spatial grid of cellSize over the particles at
+             * the end of every update, for neighbourhood and density queries.
+             * Every reorderInterval updates the particles are also moved in
+             * grid order, so that the passes reading per cell data (ground
+             * heights, snow deposition) walk memory mostly in order, 0 never
+             * reorders. A cell size of 0 removes the grid.
+             */
+            void setSpatialGrid(float cellSize, size_t reorderInterval = 0);
+
+            /**
+             * @brief Grid of the particles as of the last update, null when
+             * disabled
+             */
+            const SpatialGrid *getSpatialGrid() const;
+
+            size_t getParticleCount() const;
+            size_t getCapacity() const;
 
             void draw();
 
         private:
-            std::vector<Particle> particles;
+            /**
+             * @brief Spawns up to count particles in the box [boxMin; boxMax],
+             * drawing every attribute in one batch per attribute.
+             */
+            void spawnParticles(size_t count, Vector3 boxMin, Vector3 boxMax, float particleLifetime, RandomBatch &random);
+
+            /**
+             * @brief Spawns the particles emitted during delta, the fraction of
+             * particle left is carried over to the next frame.
+             */
+            void emit(double delta);
+
+            ParticleStorage particles;
+            std::vector<IndexType> deadIndices;
+            std::vector<size_t> deadCounts;
+            std::vector<IndexType> landedIndices;
+            // one per chunk, so that results do not depend on scheduling
+            std::vector<SnowDeposition::Accumulator> accumulators;
+            std::shared_ptr<GroundObject> ground;
+            std::shared_ptr<const WindField> wind;
+            std::unique_ptr<SpatialGrid> spatialGrid;
+            size_t reorderInterval;
             ParticleRenderer renderer;
             std::shared_ptr<ShaderProgram> shader;
             float respawnHeight;
             float textureCount; // shaders need texture id in float
+            float emissionRate;
+            float emissionAccumulator;
+            float lifetime;
+            std::shared_ptr<Camera> followedCamera;
+            Vector3 followHalfExtents;
+            std::uint64_t randomSeed;
+            std::uint64_t frameIndex;
     };
 }
\ No newline at end of file
@@ -0,0 +1,148 @@
+#include "spatial_grid.hh"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <numeric>
+
+namespace pogl
+{
+    namespace
+    {
+        // large primes of Teschner et al., "Optimized Spatial Hashing for
+        // Collision Detection of Deformable Objects"
+        constexpr std::uint32_t PRIME_X = 73856093;
+        constexpr std::uint32_t PRIME_Y = 19349663;
+        constexpr std::uint32_t PRIME_Z = 83492791;
+    } // namespace
+
+    SpatialGrid::SpatialGrid(float cell_size, size_t table_size)
+        : _cell_size(cell_size)
+        , _inverse_cell_size(1 / cell_size)
+        , _table_mask(std::bit_ceil(std::max<size_t>(table_size, 1)) - 1)
+        , _buckets()
+        , _chunk_offsets()
+        , _cell_starts(_table_mask + 1, 0)
+        , _cell_counts(_table_mask + 1, 0)
+        , _permutation()
+    {}
+
+    void SpatialGrid::rebuild(const ConstParticleView &view, JobSystem &jobs)
+    {
+        const auto count = view.size;
+        const auto table_size = this->table_size();
+        const auto chunk_count = (count + CHUNK_SIZE - 1) / CHUNK_SIZE;
+        _buckets.resize(count);
+        _permutation.resize(count);
+        _chunk_offsets.assign(chunk_count * table_size, 0);
+
+        // histogram of the buckets of every chunk
+        jobs.parallel_for(count, CHUNK_SIZE,
+                          [&](size_t chunk, size_t begin, size_t end) {
+                              auto *counts =
+                                  _chunk_offsets.data() + chunk * table_size;
+                              for (size_t i = begin; i < end; ++i)
+                              {
+                                  const auto bucket =
+                                      this->bucket(view.x[i], view.y[i],
+                                                   view.z[i]);
+                                  _buckets[i] = bucket;
+                                  counts[bucket]++;
+                              }
+                          });
+
+        // exclusive scan in (bucket, chunk) order, so that each chunk
+        // scatters after the chunks before it and the sort is stable
+        IndexType offset = 0;
+        for (size_t bucket = 0; bucket < table_size; ++bucket)
+        {
+            _cell_starts[bucket] = offset;
+            for (size_t chunk = 0; chunk < chunk_count; ++chunk)
+            {
+                auto &counter = _chunk_offsets[chunk * table_size + bucket];
+                const auto bucket_count = counter;
+                counter = offset;
+                offset += bucket_count;
+            }
+            _cell_counts[bucket] = offset - _cell_starts[bucket];
+        }
+
+        jobs.parallel_for(count, CHUNK_SIZE,
+                          [&](size_t chunk, size_t begin, size_t end) {
+                              auto *offsets =
+                                  _chunk_offsets.data() + chunk * table_size;
+                              for (size_t i = begin; i < end; ++i)
+                              {
+                                  _permutation[offsets[_buckets[i]]++] = i;
+                              }
+                          });
+    }
+
+    SpatialGrid::IndexType SpatialGrid::bucket(float x, float y,
+                                               float z) const
+    {
+        return bucket_of_cell(cell_coordinate(x), cell_coordinate(y),
+                              cell_coordinate(z));
+    }
+
+    std::span<const SpatialGrid::IndexType> SpatialGrid::cell_starts() const
+    {
+        return _cell_starts;
+    }
+
+    std::span<const SpatialGrid::IndexType> SpatialGrid::cell_counts() const
+    {
+        return _cell_counts;
+    }
+
+    std::span<const SpatialGrid::IndexType> SpatialGrid::permutation() const
+    {
+        return _permutation;
+    }
+
+    std::span<const SpatialGrid::IndexType>
+    SpatialGrid::particles(IndexType bucket) const
+    {
+        return std::span(_permutation)
+            .subspan(_cell_starts[bucket], _cell_counts[bucket]);
+    }
+
+    size_t SpatialGrid::count_at(const Vector3 &position) const
+    {
+        return _cell_counts[bucket(position.x, position.y, position.z)];
+    }
+
+    void SpatialGrid::reset_permutation(JobSystem &jobs)
+    {
+        jobs.parallel_for(_permutation.size(), CHUNK_SIZE,
+                          [&](size_t, size_t begin, size_t end) {
+                              std::iota(_permutation.begin() + begin,
+                                        _permutation.begin() + end,
+                                        (IndexType)begin);
+                          });
+    }
+
+    float SpatialGrid::cell_size() const
+    {
+        return _cell_size;
+    }
+
+    size_t SpatialGrid::table_size() const
+    {
+        return (size_t)_table_mask + 1;
+    }
+
+    std::int32_t SpatialGrid::cell_coordinate(float position) const
+    {
+        return (std::int32_t)std::floor(position * _inverse_cell_size);
+    }
+
+    SpatialGrid::IndexType SpatialGrid::bucket_of_cell(std::int32_t x,
+                                                       std::int32_t y,
+                                                       std::int32_t z) const
+    {
+        const auto hash = ((std::uint32_t)x * PRIME_X)
+            ^ ((std::uint32_t)y * PRIME_Y) ^ ((std::uint32_t)z * PRIME_Z);
+        return hash & _table_mask;
+    }
+} // namespace pogl
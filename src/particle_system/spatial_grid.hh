@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "jobs/job_system.hh"
+#include "particle_storage.hh"
+#include "vector3/vector3.hh"
+
+namespace pogl
+{
+    /**
+     * @brief Uniform grid over the particles, rebuilt from scratch every
+     * frame.
+     *
+     * The grid covers all of space: cells are hashed into a fixed table of
+     * buckets, so several distant cells may share a bucket. A counting sort
+     * groups the particle indices by bucket, in increasing index order
+     * within each bucket. Both passes over the particles run in parallel and
+     * the whole rebuild is linear in the number of particles.
+     */
+    class SpatialGrid
+    {
+    public:
+        using IndexType = std::uint32_t;
+
+        static constexpr size_t DEFAULT_TABLE_SIZE = 4096;
+        /**
+         * @brief Particles hashed or scattered by one job
+         */
+        static constexpr size_t CHUNK_SIZE = 16384;
+
+        /**
+         * @param cell_size edge of the cubic cells
+         * @param table_size number of buckets, rounded up to a power of two
+         */
+        explicit SpatialGrid(float cell_size,
+                             size_t table_size = DEFAULT_TABLE_SIZE);
+
+        /**
+         * @brief Sorts the particles of view by bucket
+         *
+         * @param view
+         * @param jobs
+         */
+        void rebuild(const ConstParticleView &view, JobSystem &jobs);
+
+        /**
+         * @brief Bucket of the cell holding a position
+         *
+         * @param x
+         * @param y
+         * @param z
+         * @return IndexType
+         */
+        IndexType bucket(float x, float y, float z) const;
+
+        /**
+         * @brief Index in permutation of the first particle of each bucket
+         *
+         * @return std::span<const IndexType>
+         */
+        std::span<const IndexType> cell_starts() const;
+        std::span<const IndexType> cell_counts() const;
+
+        /**
+         * @brief Particle indices grouped by bucket
+         *
+         * @return std::span<const IndexType>
+         */
+        std::span<const IndexType> permutation() const;
+
+        /**
+         * @brief Particles of a bucket
+         *
+         * @param bucket
+         * @return std::span<const IndexType>
+         */
+        std::span<const IndexType> particles(IndexType bucket) const;
+
+        /**
+         * @brief Number of particles in the bucket of a position, a cheap
+         * upper bound of the local density
+         *
+         * @param position
+         * @return size_t
+         */
+        size_t count_at(const Vector3 &position) const;
+
+        /**
+         * @brief Calls function(index) for every particle in the 27 cells
+         * around position. Particles of other cells sharing the buckets are
+         * included, callers test the actual distance.
+         *
+         * @param position
+         * @param function
+         */
+        template <typename Function>
+        void for_each_near(const Vector3 &position, Function &&function) const;
+
+        /**
+         * @brief To be called once the particles have been moved into
+         * permutation order, see ParticleStorage::reorder: the permutation
+         * becomes the identity and the buckets stay valid.
+         *
+         * @param jobs
+         */
+        void reset_permutation(JobSystem &jobs);
+
+        float cell_size() const;
+        size_t table_size() const;
+
+    private:
+        std::int32_t cell_coordinate(float position) const;
+        IndexType bucket_of_cell(std::int32_t x, std::int32_t y,
+                                 std::int32_t z) const;
+
+        float _cell_size;
+        float _inverse_cell_size;
+        IndexType _table_mask;
+        // bucket of every particle
+        std::vector<IndexType> _buckets;
+        // table_size counters per chunk, turned into scatter offsets
+        std::vector<IndexType> _chunk_offsets;
+        std::vector<IndexType> _cell_starts;
+        std::vector<IndexType> _cell_counts;
+        std::vector<IndexType> _permutation;
+    };
+} // namespace pogl
+
+#include "spatial_grid.hxx"
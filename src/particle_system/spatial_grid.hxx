@@ -0,0 +1,42 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+
+#include "spatial_grid.hh"
+
+namespace pogl
+{
+    template <typename Function>
+    void SpatialGrid::for_each_near(const Vector3 &position,
+                                    Function &&function) const
+    {
+        const auto x = cell_coordinate(position.x);
+        const auto y = cell_coordinate(position.y);
+        const auto z = cell_coordinate(position.z);
+
+        // neighbouring cells may share a bucket, each is visited once
+        std::array<IndexType, 27> visited;
+        size_t visited_count = 0;
+        for (std::int32_t dz = -1; dz <= 1; ++dz)
+        {
+            for (std::int32_t dy = -1; dy <= 1; ++dy)
+            {
+                for (std::int32_t dx = -1; dx <= 1; ++dx)
+                {
+                    const auto bucket = bucket_of_cell(x + dx, y + dy, z + dz);
+                    const auto end = visited.begin() + visited_count;
+                    if (std::find(visited.begin(), end, bucket) != end)
+                    {
+                        continue;
+                    }
+                    visited[visited_count++] = bucket;
+                    for (auto index : particles(bucket))
+                    {
+                        function(index);
+                    }
+                }
+            }
+        }
+    }
+} // namespace pogl
@@ -0,0 +1,218 @@
+#include "wind_field.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "utils/cpu_features.hh"
+#include "utils/log.hh"
+#include "utils/rng.hh"
+
+namespace pogl
+{
+    namespace
+    {
+        // keeps the gusts apart from the generators of the particle system
+        constexpr std::uint64_t RANDOM_STREAM = 0x77696e64;
+        constexpr int MAX_WAVE_NUMBER = 2;
+        constexpr float MIN_GUST_FREQUENCY = 0.2;
+        constexpr float MAX_GUST_FREQUENCY = 1;
+        // gusts mostly blow horizontally
+        constexpr float MAX_GUST_SLOPE = 0.2;
+
+        int wave_number(Xoshiro256 &random)
+        {
+            return (int)(random() % (2 * MAX_WAVE_NUMBER + 1))
+                - MAX_WAVE_NUMBER;
+        }
+
+        struct Axis
+        {
+            int first; // node offsets of the two neighbours
+            int second;
+            float weight; // of the second one
+        };
+
+        // coordinate in cells wrapped into [0; size], the last cell
+        // interpolates towards node 0
+        Axis wrap_axis(float position, float inverse_cell_size, int size,
+                       int stride)
+        {
+            const auto cells = position * inverse_cell_size;
+            const auto wrapped =
+                cells - std::floor(cells * (1.f / size)) * size;
+            // max first so that NaN clamps to 0
+            const auto index = (int)std::min(
+                std::max(0.f, std::floor(wrapped)), (float)(size - 1));
+            const auto next = index + 1 == size ? 0 : index + 1;
+            return Axis{ index * stride, next * stride, wrapped - index };
+        }
+
+        float trilinear(const float *values, const Axis &x,
+                        const Axis &y, const Axis &z)
+        {
+            const auto at = [&](int ox, int oy, int oz) {
+                return values[ox + oy + oz];
+            };
+            const auto c00 = at(x.first, y.first, z.first);
+            const auto c10 = at(x.first, y.second, z.first);
+            const auto c01 = at(x.first, y.first, z.second);
+            const auto c11 = at(x.first, y.second, z.second);
+            const auto c00_x = c00
+                + x.weight * (at(x.second, y.first, z.first) - c00);
+            const auto c10_x = c10
+                + x.weight * (at(x.second, y.second, z.first) - c10);
+            const auto c01_x = c01
+                + x.weight * (at(x.second, y.first, z.second) - c01);
+            const auto c11_x = c11
+                + x.weight * (at(x.second, y.second, z.second) - c11);
+            const auto c0 = c00_x + y.weight * (c10_x - c00_x);
+            const auto c1 = c01_x + y.weight * (c11_x - c01_x);
+            return c0 + z.weight * (c1 - c0);
+        }
+    } // namespace
+
+    WindField::WindField(const Vector3 &base_wind, float gust_strength,
+                         float cell_size, int size_x, int size_y, int size_z)
+        : _base_wind(base_wind)
+        , _cell_size(cell_size)
+        , _size_x(size_x)
+        , _size_y(size_y)
+        , _size_z(size_z)
+        , _gusts()
+        , _time(0)
+        , _u()
+        , _v()
+        , _w()
+    {
+        if (cell_size <= 0 || size_x < 1 || size_y < 1 || size_z < 1)
+        {
+            std::cerr << LOG_ERROR << "invalid wind grid of " << size_x << "x"
+                      << size_y << "x" << size_z << " cells of " << cell_size
+                      << std::endl;
+            throw std::logic_error("Invalid wind grid");
+        }
+        const auto node_count = (size_t)size_x * size_y * size_z;
+        _u.resize(node_count);
+        _v.resize(node_count);
+        _w.resize(node_count);
+
+        Xoshiro256 random(global_seed(), RANDOM_STREAM);
+        for (auto &gust : _gusts)
+        {
+            // whole periods over the grid so that it repeats seamlessly
+            auto x = wave_number(random);
+            const auto y = wave_number(random);
+            if (x == 0 && y == 0)
+            {
+                x = 1;
+            }
+            const auto z = (int)(random() % 2);
+            gust.wave = Vector3(2 * M_PI * x / (size_x * cell_size),
+                                2 * M_PI * y / (size_y * cell_size),
+                                2 * M_PI * z / (size_z * cell_size));
+
+            const auto angle = random.range(0, 2 * M_PI);
+            const auto direction =
+                Vector3(std::cos(angle), std::sin(angle),
+                        random.range(-MAX_GUST_SLOPE, MAX_GUST_SLOPE));
+            gust.direction = direction.normalized()
+                * random.range(gust_strength / 4, gust_strength);
+            // the gusts drift with the base wind
+            gust.frequency = gust.wave.dot(_base_wind)
+                + random.range(MIN_GUST_FREQUENCY, MAX_GUST_FREQUENCY);
+            gust.phase = random.range(0, 2 * M_PI);
+        }
+        update(0);
+    }
+
+    void WindField::update(double delta)
+    {
+        _time += delta;
+        std::array<float, GUST_COUNT> offsets;
+        for (size_t i = 0; i < GUST_COUNT; ++i)
+        {
+            // in double, the time keeps growing
+            offsets[i] = std::fmod(
+                _gusts[i].phase - _gusts[i].frequency * _time, 2 * M_PI);
+        }
+
+        size_t node = 0;
+        for (int z = 0; z < _size_z; ++z)
+        {
+            for (int y = 0; y < _size_y; ++y)
+            {
+                for (int x = 0; x < _size_x; ++x, ++node)
+                {
+                    const auto position =
+                        Vector3(x * _cell_size, y * _cell_size, z * _cell_size);
+                    auto wind = _base_wind;
+                    for (size_t i = 0; i < GUST_COUNT; ++i)
+                    {
+                        const auto &gust = _gusts[i];
+                        wind += gust.direction
+                            * std::sin(gust.wave.dot(position) + offsets[i]);
+                    }
+                    _u[node] = wind.x;
+                    _v[node] = wind.y;
+                    _w[node] = wind.z;
+                }
+            }
+        }
+    }
+
+    void WindField::advect(const ParticleView &view, float dt) const
+    {
+        const auto field = grid();
+#if defined(__x86_64__) || defined(__i386__)
+        if (cpu_features().avx2)
+        {
+            kernels::advect_avx2(field, view, dt);
+            return;
+        }
+#endif
+        kernels::advect_scalar(field, view, 0, dt);
+    }
+
+    Vector3 WindField::sample(const Vector3 &position) const
+    {
+        const auto inverse_cell_size = 1 / _cell_size;
+        const auto x = wrap_axis(position.x, inverse_cell_size, _size_x, 1);
+        const auto y =
+            wrap_axis(position.y, inverse_cell_size, _size_y, _size_x);
+        const auto z = wrap_axis(position.z, inverse_cell_size, _size_z,
+                                 _size_x * _size_y);
+        return Vector3(trilinear(_u.data(), x, y, z),
+                       trilinear(_v.data(), x, y, z),
+                       trilinear(_w.data(), x, y, z));
+    }
+
+    WindField::Grid WindField::grid() const
+    {
+        return Grid{
+            _size_x,   _size_y,   _size_z,   1 / _cell_size,
+            _u.data(), _v.data(), _w.data(),
+        };
+    }
+
+    namespace kernels
+    {
+        void advect_scalar(const WindField::Grid &grid,
+                           const ParticleView &view, size_t begin, float dt)
+        {
+            const auto layer = grid.size_x * grid.size_y;
+            for (size_t i = begin; i < view.size; ++i)
+            {
+                const auto x = wrap_axis(view.x[i], grid.inverse_cell_size,
+                                         grid.size_x, 1);
+                const auto y = wrap_axis(view.y[i], grid.inverse_cell_size,
+                                         grid.size_y, grid.size_x);
+                const auto z = wrap_axis(view.z[i], grid.inverse_cell_size,
+                                         grid.size_z, layer);
+                view.x[i] += trilinear(grid.u, x, y, z) * dt;
+                view.y[i] += trilinear(grid.v, x, y, z) * dt;
+                view.z[i] += trilinear(grid.w, x, y, z) * dt;
+            }
+        }
+    } // namespace kernels
+} // namespace pogl
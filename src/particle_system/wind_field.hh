@@ -0,0 +1,115 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include "particle_storage.hh"
+#include "properties/updateable.hh"
+#include "vector3/vector3.hh"
+
+namespace pogl
+{
+    /**
+     * @brief Wind blowing over the whole world, carrying the flakes along.
+     *
+     * Wind vectors are stored at the nodes of a small regular grid which
+     * repeats over space, so that the field covers any area at a fixed cost.
+     * Every update re-evaluates the nodes: a constant base wind plus a few
+     * gusts, waves drifting with the base wind. Particles read the field with
+     * trilinear interpolation between the eight nodes around them.
+     */
+    class WindField : public Updateable
+    {
+    public:
+        static constexpr float DEFAULT_CELL_SIZE = 1;
+        static constexpr int DEFAULT_SIZE_X = 16;
+        static constexpr int DEFAULT_SIZE_Y = 16;
+        static constexpr int DEFAULT_SIZE_Z = 8;
+        static constexpr size_t GUST_COUNT = 4;
+
+        /**
+         * @brief Flat view of the nodes read by the kernels
+         */
+        struct Grid
+        {
+            int size_x;
+            int size_y;
+            int size_z;
+            float inverse_cell_size;
+            // node (x, y, z) is at (z * size_y + y) * size_x + x
+            const float *u;
+            const float *v;
+            const float *w;
+        };
+
+        /**
+         * @param base_wind wind blowing everywhere, in units per second
+         * @param gust_strength largest speed a single gust adds to it
+         * @param cell_size distance between two nodes
+         * @param size_x number of nodes along x before the grid repeats
+         * @param size_y
+         * @param size_z
+         */
+        WindField(const Vector3 &base_wind, float gust_strength,
+                  float cell_size = DEFAULT_CELL_SIZE,
+                  int size_x = DEFAULT_SIZE_X, int size_y = DEFAULT_SIZE_Y,
+                  int size_z = DEFAULT_SIZE_Z);
+        virtual ~WindField() = default;
+
+        /**
+         * @brief Moves the gusts forward in time and evaluates the nodes
+         *
+         * @param delta
+         */
+        virtual void update(double delta) override;
+
+        /**
+         * @brief Moves every particle of view by the wind at its position
+         * during dt. Flakes are light enough to follow the air instantly, so
+         * their own velocity is left untouched.
+         *
+         * @param view
+         * @param dt
+         */
+        void advect(const ParticleView &view, float dt) const;
+
+        /**
+         * @brief Wind at a world position
+         *
+         * @param position
+         * @return Vector3
+         */
+        Vector3 sample(const Vector3 &position) const;
+
+        Grid grid() const;
+
+    private:
+        struct Gust
+        {
+            Vector3 direction; // scaled by the strength of the gust
+            Vector3 wave; // wave vector, whole periods over the grid
+            float frequency; // radians per second
+            float phase;
+        };
+
+        Vector3 _base_wind;
+        float _cell_size;
+        int _size_x;
+        int _size_y;
+        int _size_z;
+        std::array<Gust, GUST_COUNT> _gusts;
+        double _time;
+        std::vector<float> _u;
+        std::vector<float> _v;
+        std::vector<float> _w;
+    };
+
+    namespace kernels
+    {
+        void advect_scalar(const WindField::Grid &grid,
+                           const ParticleView &view, size_t begin, float dt);
+        void advect_avx2(const WindField::Grid &grid, const ParticleView &view,
+                         float dt);
+    } // namespace kernels
+} // namespace pogl
@@ -0,0 +1,124 @@
+#include "wind_field.hh"
+
+#if defined(__x86_64__) || defined(__i386__)
+#    include <immintrin.h>
+
+namespace pogl::kernels
+{
+    // Eight particles at a time: the eight nodes around each of them are
+    // gathered from every component of the grid. Same operations in the same
+    // order as the scalar kernel, so both give the same positions.
+
+    namespace
+    {
+        struct AxisAvx2
+        {
+            __m256i first;
+            __m256i second;
+            __m256 weight;
+        };
+
+        __attribute__((target("avx2"))) inline AxisAvx2
+        wrap_axis_avx2(__m256 position, __m256 inverse_cell_size, int size,
+                       int stride)
+        {
+            const auto size_v = _mm256_set1_epi32(size);
+            const auto cells = _mm256_mul_ps(position, inverse_cell_size);
+            const auto wrapped = _mm256_sub_ps(
+                cells,
+                _mm256_mul_ps(_mm256_floor_ps(_mm256_mul_ps(
+                                  cells, _mm256_set1_ps(1.f / size))),
+                              _mm256_set1_ps((float)size)));
+            // max returns its second operand for NaN
+            const auto index = _mm256_cvttps_epi32(_mm256_min_ps(
+                _mm256_max_ps(_mm256_floor_ps(wrapped), _mm256_setzero_ps()),
+                _mm256_set1_ps((float)(size - 1))));
+            auto next = _mm256_add_epi32(index, _mm256_set1_epi32(1));
+            next = _mm256_andnot_si256(_mm256_cmpeq_epi32(next, size_v), next);
+            const auto stride_v = _mm256_set1_epi32(stride);
+            return AxisAvx2{
+                _mm256_mullo_epi32(index, stride_v),
+                _mm256_mullo_epi32(next, stride_v),
+                _mm256_sub_ps(wrapped, _mm256_cvtepi32_ps(index)),
+            };
+        }
+
+        __attribute__((target("avx2"))) inline __m256
+        lerp_avx2(__m256 from, __m256 to, __m256 weight)
+        {
+            return _mm256_add_ps(
+                from, _mm256_mul_ps(weight, _mm256_sub_ps(to, from)));
+        }
+
+        __attribute__((target("avx2"))) inline __m256
+        trilinear_avx2(const float *values, const __m256i (&corners)[8],
+                       const AxisAvx2 &x, const AxisAvx2 &y,
+                       const AxisAvx2 &z)
+        {
+            __m256 c[8];
+            for (int i = 0; i < 8; ++i)
+            {
+                c[i] = _mm256_i32gather_ps(values, corners[i], 4);
+            }
+            // corner bits: x, y, z from lowest to highest
+            const auto c00_x = lerp_avx2(c[0], c[1], x.weight);
+            const auto c10_x = lerp_avx2(c[2], c[3], x.weight);
+            const auto c01_x = lerp_avx2(c[4], c[5], x.weight);
+            const auto c11_x = lerp_avx2(c[6], c[7], x.weight);
+            const auto c0 = lerp_avx2(c00_x, c10_x, y.weight);
+            const auto c1 = lerp_avx2(c01_x, c11_x, y.weight);
+            return lerp_avx2(c0, c1, z.weight);
+        }
+    } // namespace
+
+    __attribute__((target("avx2"))) void
+    advect_avx2(const WindField::Grid &grid, const ParticleView &view,
+                float dt)
+    {
+        constexpr size_t LANES = 8;
+        const auto inverse_cell_size = _mm256_set1_ps(grid.inverse_cell_size);
+        const auto dt_v = _mm256_set1_ps(dt);
+        const auto layer = grid.size_x * grid.size_y;
+        size_t i = 0;
+        for (; i + LANES <= view.size; i += LANES)
+        {
+            const auto px = _mm256_loadu_ps(view.x + i);
+            const auto py = _mm256_loadu_ps(view.y + i);
+            const auto pz = _mm256_loadu_ps(view.z + i);
+            const auto x =
+                wrap_axis_avx2(px, inverse_cell_size, grid.size_x, 1);
+            const auto y = wrap_axis_avx2(py, inverse_cell_size, grid.size_y,
+                                          grid.size_x);
+            const auto z =
+                wrap_axis_avx2(pz, inverse_cell_size, grid.size_z, layer);
+
+            __m256i corners[8];
+            for (int corner = 0; corner < 8; ++corner)
+            {
+                corners[corner] = _mm256_add_epi32(
+                    _mm256_add_epi32(corner & 1 ? x.second : x.first,
+                                     corner & 2 ? y.second : y.first),
+                    corner & 4 ? z.second : z.first);
+            }
+
+            _mm256_storeu_ps(
+                view.x + i,
+                _mm256_add_ps(px, _mm256_mul_ps(trilinear_avx2(grid.u, corners,
+                                                               x, y, z),
+                                                dt_v)));
+            _mm256_storeu_ps(
+                view.y + i,
+                _mm256_add_ps(py, _mm256_mul_ps(trilinear_avx2(grid.v, corners,
+                                                               x, y, z),
+                                                dt_v)));
+            _mm256_storeu_ps(
+                view.z + i,
+                _mm256_add_ps(pz, _mm256_mul_ps(trilinear_avx2(grid.w, corners,
+                                                               x, y, z),
+                                                dt_v)));
+        }
+        advect_scalar(grid, view, i, dt);
+    }
+} // namespace pogl::kernels
+
+#endif // x86
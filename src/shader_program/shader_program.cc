@@ -16,9 +16,11 @@ namespace pogl
                                  const std::string &fragment_src, bool ready)
         : _vertexSrc(vertex_src)
         , _fragSrc(fragment_src)
+        , _computeSrc()
         , _ready(ready)
         , _vertex(0)
         , _fragment(0)
+        , _compute(0)
         , _program(0)
         , _compilation_log()
         , _uniforms()
@@ -115,16 +117,38 @@ namespace pogl
                                     _fragSrc);
     }
 
-    bool ShaderProgram::link_program()
+    bool ShaderProgram::compile_compute()
     {
-        _program = glCreateProgram();
+        _compute = glCreateShader(GL_COMPUTE_SHADER);
         CHECK_GL_ERROR();
 
-        glAttachShader(_program, _vertex);
+        const auto compute_shader_code = load_file(_computeSrc);
+        const char *compute_sources[] = { compute_shader_code.c_str() };
+        glShaderSource(_compute, 1, compute_sources, NULL);
         CHECK_GL_ERROR();
-        glAttachShader(_program, _fragment);
+
+        glCompileShader(_compute);
+        return check_gl_compilation(_compute, _compilation_log, "COMPUTE",
+                                    _computeSrc);
+    }
+
+    bool ShaderProgram::link_program()
+    {
+        _program = glCreateProgram();
         CHECK_GL_ERROR();
 
+        // a program is either made of a vertex and a fragment shader, or of
+        // a compute shader alone
+        const ShaderIdType shaders[] = { _vertex, _fragment, _compute };
+        for (auto shader : shaders)
+        {
+            if (shader != 0)
+            {
+                glAttachShader(_program, shader);
+                CHECK_GL_ERROR();
+            }
+        }
+
         glLinkProgram(_program);
         // check linking success
         GLint is_linked = 0;
@@ -152,13 +176,19 @@ namespace pogl
             CHECK_GL_ERROR();
             glDeleteShader(_vertex);
             CHECK_GL_ERROR();
+            glDeleteShader(_compute);
+            CHECK_GL_ERROR();
             return false;
         }
 
-        glDetachShader(_program, _vertex);
-        CHECK_GL_ERROR();
-        glDetachShader(_program, _fragment);
-        CHECK_GL_ERROR();
+        for (auto shader : shaders)
+        {
+            if (shader != 0)
+            {
+                glDetachShader(_program, shader);
+                CHECK_GL_ERROR();
+            }
+        }
         return true;
     }
 
@@ -169,6 +199,8 @@ namespace pogl
         errored = errored || CHECK_GL_ERROR();
         glDeleteShader(_fragment);
         errored = errored || CHECK_GL_ERROR();
+        glDeleteShader(_compute);
+        errored = errored || CHECK_GL_ERROR();
 
         _ready = !errored;
         return !errored;
@@ -309,6 +341,38 @@ namespace pogl
         return prog;
     }
 
+    std::shared_ptr<Self>
+    ShaderProgram::make_compute_program(const std::string &compute_src)
+    {
+        auto prog = std::make_unique<Self>("", "", false);
+        prog->_computeSrc = compute_src;
+        if (!prog->compile_compute())
+        {
+            constexpr auto msg = "The compute shader's compilation failed";
+            std::cerr << msg << std::endl;
+            throw std::runtime_error(msg);
+        }
+
+        const auto linked = prog->link_program();
+        if (!linked)
+        {
+            constexpr auto msg = "Shader program linking failed";
+            std::cerr << msg << std::endl;
+            throw std::runtime_error(msg);
+        }
+        const auto post = prog->post_compilation();
+        if (!post)
+        {
+            constexpr auto msg = "Error in post compilation";
+            std::cerr << msg << std::endl;
+            throw std::runtime_error(msg);
+        }
+
+        prog->build_uniform_map();
+
+        return prog;
+    }
+
     std::string &ShaderProgram::get_log()
     {
         return _compilation_log;
@@ -335,6 +399,14 @@ namespace pogl
         CHECK_GL_ERROR();
     }
 
+    void ShaderProgram::dispatch(GLuint groups_x, GLuint groups_y,
+                                 GLuint groups_z)
+    {
+        activate();
+        glDispatchCompute(groups_x, groups_y, groups_z);
+        CHECK_GL_ERROR();
+    }
+
     ShaderProgram::ProgramIdType ShaderProgram::get_program()
     {
         return _program;
@@ -50,6 +50,17 @@ namespace pogl
         static std::shared_ptr<Self>
         make_program(const std::string &vertex_src,
                      const std::string &fragment_src);
+
+        /**
+         * @brief Creates and compiles a new compute program from the contents
+         * of the file at compute_src.
+         *
+         * @param compute_src Path to the compute shader source file
+         * @return Self
+         */
+        static std::shared_ptr<Self>
+        make_compute_program(const std::string &compute_src);
+
         /**
          * @brief Get the compilation log
          *
@@ -86,6 +97,17 @@ namespace pogl
             activate();
         }
 
+        /**
+         * @brief Runs a compute program over the given number of work
+         * groups. Memory barriers are left to the caller.
+         *
+         * @param groups_x
+         * @param groups_y
+         * @param groups_z
+         */
+        void dispatch(GLuint groups_x, GLuint groups_y = 1,
+                      GLuint groups_z = 1);
+
         /**
          * @brief Get the wrapped program id
          *
@@ -149,6 +171,7 @@ namespace pogl
     private:
         bool compile_vertex();
         bool compile_fragment();
+        bool compile_compute();
         bool link_program();
         bool post_compilation();
         void build_uniform_map();
@@ -156,10 +179,12 @@ namespace pogl
 
         fs::path _vertexSrc;
         fs::path _fragSrc;
+        fs::path _computeSrc;
         bool _ready;
 
         ShaderIdType _vertex;
         ShaderIdType _fragment;
+        ShaderIdType _compute;
         ProgramIdType _program;
         std::string _compilation_log;
         UniformMapType _uniforms;
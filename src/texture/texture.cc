@@ -1,5 +1,9 @@
 #include "texture.hh"
 
+#include <algorithm>
+#include <cstring>
+
+#include "utils/buffer_offset_macro.hh"
 #include "utils/gl_check.hh"
 
 namespace pogl
@@ -12,6 +16,7 @@ namespace pogl
         : _texture_id(texture_id)
         , _target(target)
         , _format(format)
+        , _upload_buffer(nullptr)
     {}
 
     Texture::~Texture()
@@ -60,6 +65,161 @@ namespace pogl
         }
     }
 
+    void Texture::set_image(const HeightMap &map)
+    {
+        glActiveTexture(GL_TEXTURE0);
+        CHECK_GL_ERROR();
+        use();
+
+        _format = map.internal_format();
+        // rows of 8 and 16 bit texels are not padded to 4 bytes
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        CHECK_GL_ERROR();
+        glTexImage2D(_target, 0, _format, map.width(), map.height(), 0, GL_RED,
+                     map.pixel_type(), map.data());
+        CHECK_GL_ERROR();
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        CHECK_GL_ERROR();
+    }
+
+    void Texture::update_regions(const HeightMap &map,
+                                 std::span<const HeightMap::Region> regions)
+    {
+        stream_regions(map.data(), map.width(), map.height(),
+                       map.texel_size(), regions, GL_RED, map.pixel_type());
+    }
+
+    void Texture::stream_regions(const std::byte *pixels, GLsizei width,
+                                 GLsizei height, size_t texel_size,
+                                 std::span<const ImageRegion> regions,
+                                 GLenum src_format, GLenum type)
+    {
+        if (regions.empty())
+        {
+            return;
+        }
+
+        // most of the image changed: one copy from client memory, the
+        // driver stages it without waiting on the ring
+        size_t changed = 0;
+        for (const auto &region : regions)
+        {
+            changed += (size_t)region.width * region.height;
+        }
+        if (changed > FULL_UPLOAD_SHARE * width * height)
+        {
+            glActiveTexture(GL_TEXTURE0);
+            CHECK_GL_ERROR();
+            use();
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            CHECK_GL_ERROR();
+            glTexSubImage2D(_target, 0, 0, 0, width, height, src_format, type,
+                            pixels);
+            CHECK_GL_ERROR();
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+            CHECK_GL_ERROR();
+            return;
+        }
+
+        // sized in tiles, wide enough for a row of every region
+        auto row_capacity = (size_t)FloatImageBuffer::TILE_SIZE;
+        for (const auto &region : regions)
+        {
+            row_capacity = std::max<size_t>(row_capacity, region.width);
+        }
+        const auto band_size =
+            FloatImageBuffer::TILE_SIZE * row_capacity * texel_size;
+        if (!_upload_buffer || _upload_buffer->region_size() < band_size)
+        {
+            _upload_buffer = std::make_unique<StreamBuffer>(
+                GL_PIXEL_UNPACK_BUFFER, UPLOAD_TILES_PER_REGION * band_size);
+        }
+
+        glActiveTexture(GL_TEXTURE0);
+        CHECK_GL_ERROR();
+        use();
+        _upload_buffer->bind();
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        CHECK_GL_ERROR();
+
+        // rows are packed tightly, a region that does not fit in what is left
+        // of the current ring region is split by rows over the next one
+        const auto region_size = _upload_buffer->region_size();
+        const auto line_size = width * texel_size;
+        std::byte *mapping = nullptr;
+        size_t used = 0;
+        for (const auto &region : regions)
+        {
+            const size_t row_size = region.width * texel_size;
+            if (row_size == 0)
+            {
+                continue;
+            }
+            for (int y = 0; y < region.height;)
+            {
+                if (mapping == nullptr || region_size - used < row_size)
+                {
+                    if (mapping != nullptr)
+                    {
+                        _upload_buffer->end_region();
+                    }
+                    mapping = static_cast<std::byte *>(
+                        _upload_buffer->begin_region());
+                    used = 0;
+                }
+                const auto rows = std::min<size_t>(region.height - y,
+                                                   (region_size - used)
+                                                       / row_size);
+                const auto *source = pixels + (region.y + y) * line_size
+                    + region.x * texel_size;
+                for (size_t row = 0; row < rows; ++row)
+                {
+                    std::memcpy(mapping + used + row * row_size,
+                                source + row * line_size, row_size);
+                }
+                glTexSubImage2D(
+                    _target, 0, region.x, region.y + y, region.width, rows,
+                    src_format, type,
+                    BUFFER_OFFSET(_upload_buffer->region_offset() + used));
+                CHECK_GL_ERROR();
+                used += rows * row_size;
+                y += rows;
+            }
+        }
+        if (mapping != nullptr)
+        {
+            _upload_buffer->end_region();
+        }
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        CHECK_GL_ERROR();
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        CHECK_GL_ERROR();
+    }
+
+    void Texture::allocate(GLsizei width, GLsizei height, GLenum src_format,
+                           GLenum type)
+    {
+        glActiveTexture(GL_TEXTURE0);
+        CHECK_GL_ERROR();
+        use();
+
+        glTexImage2D(_target, 0, _format, width, height, 0, src_format, type,
+                     nullptr);
+        CHECK_GL_ERROR();
+    }
+
+    void Texture::attach(GLenum attachment)
+    {
+        glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, _target,
+                               _texture_id, 0);
+        CHECK_GL_ERROR();
+    }
+
+    GLuint Texture::id() const
+    {
+        return _texture_id;
+    }
+
     Texture::Builder Texture::builder()
     {
         return Builder();
@@ -4,8 +4,11 @@
 #include <filesystem>
 #include <memory>
 #include <optional>
+#include <span>
 #include <variant>
 
+#include "buffer/stream_buffer.hh"
+#include "image/height_map.hh"
 #include "image/image_buffer.hh"
 #include "vector4/vector4.hh"
 
@@ -16,7 +19,7 @@ namespace pogl
     {
     public:
         using RGBBuffersType = std::vector<RGBImageBuffer>;
-        using BufferVariantType = std::optional<std::variant<RGBImageBuffer, FloatImageBuffer, RGBBuffersType>>;
+        using BufferVariantType = std::optional<std::variant<RGBImageBuffer, FloatImageBuffer, RGBBuffersType, HeightMap>>;
 
         class Builder
         {
@@ -132,12 +135,77 @@ namespace pogl
         void set_image(const FloatImageBuffer &buffer, GLenum src_format,
                    bool generate_mipmap = true);
 
+        /**
+         * @brief Tiles copied to the upload buffer per frame before waiting
+         * for the GPU
+         */
+        static constexpr size_t UPLOAD_TILES_PER_REGION = 64;
+        /**
+         * @brief Share of the texels changed past which update_regions
+         * uploads the whole image in one call rather than streaming tiles
+         * through the ring, whose fences would be waited on several times
+         * per frame.
+         */
+        static constexpr float FULL_UPLOAD_SHARE = 0.5;
+
+        /**
+         * @brief Reallocates the texture with the internal format of map,
+         * e.g. GL_R16 for 16 bit unorm heights, and uploads it without
+         * mipmaps.
+         *
+         * @param map
+         */
+        void set_image(const HeightMap &map);
+
+        /**
+         * @brief Uploads regions of map to the same texels of the texture,
+         * at the precision of map and without mipmaps, see set_image. The
+         * rows are packed into a ring of pixel unpack buffers and copied by
+         * the GPU asynchronously, only the changed texels cross the bus.
+         * Past FULL_UPLOAD_SHARE of the texels, the whole map is uploaded at
+         * once instead.
+         *
+         * @param map of the size of the texture
+         * @param regions typically HeightMap::take_dirty_regions
+         */
+        void update_regions(const HeightMap &map,
+                            std::span<const HeightMap::Region> regions);
+
+        /**
+         * @brief Allocates uninitialised storage, for textures rendered to
+         * rather than loaded from an image.
+         *
+         * @param width
+         * @param height
+         * @param src_format
+         * @param type
+         */
+        void allocate(GLsizei width, GLsizei height, GLenum src_format,
+                      GLenum type);
+
+        /**
+         * @brief Attaches level 0 of the texture to the framebuffer bound to
+         * GL_FRAMEBUFFER, to render into it.
+         *
+         * @param attachment e.g. GL_COLOR_ATTACHMENT0
+         */
+        void attach(GLenum attachment);
+
         void use();
 
+        GLuint id() const;
+
     private:
+        void stream_regions(const std::byte *pixels, GLsizei width,
+                            GLsizei height, size_t texel_size,
+                            std::span<const ImageRegion> regions,
+                            GLenum src_format, GLenum type);
+
         GLuint _texture_id;
         GLenum _target;
         GLenum _format;
+        // created on the first update_regions
+        std::unique_ptr<StreamBuffer> _upload_buffer;
     };
 
 } // namespace pogl
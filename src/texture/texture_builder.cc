@@ -173,6 +173,19 @@ namespace pogl
                          0, _src_format, GL_UNSIGNED_BYTE, buffer.data());
             CHECK_GL_ERROR();
         }
+        else if (std::holds_alternative<HeightMap>(*_texture_buffer))
+        {
+            // single channel, the format should match the precision, see
+            // HeightMap::internal_format
+            auto &map = std::get<HeightMap>(*_texture_buffer);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            CHECK_GL_ERROR();
+            glTexImage2D(_target, 0, _format, map.width(), map.height(), 0,
+                         GL_RED, map.pixel_type(), map.data());
+            CHECK_GL_ERROR();
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+            CHECK_GL_ERROR();
+        }
         else
         {
             auto &buffer = std::get<FloatImageBuffer>(*_texture_buffer);
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace pogl
+{
+    /**
+     * @brief Allocator returning storage aligned on `Alignment` bytes, so
+     * that arrays can be streamed with aligned SIMD loads and stores.
+     *
+     * @tparam T element type
+     * @tparam Alignment alignment in bytes, 32 fits an AVX register
+     */
+    template <typename T, std::size_t Alignment = 32>
+    class AlignedAllocator
+    {
+    public:
+        using value_type = T;
+
+        template <typename U>
+        struct rebind
+        {
+            using other = AlignedAllocator<U, Alignment>;
+        };
+
+        AlignedAllocator() noexcept = default;
+
+        template <typename U>
+        AlignedAllocator(const AlignedAllocator<U, Alignment> &) noexcept
+        {}
+
+        T *allocate(std::size_t count)
+        {
+            return static_cast<T *>(::operator new(
+                count * sizeof(T), std::align_val_t(Alignment)));
+        }
+
+        void deallocate(T *pointer, std::size_t) noexcept
+        {
+            ::operator delete(pointer, std::align_val_t(Alignment));
+        }
+
+        template <typename U>
+        bool operator==(const AlignedAllocator<U, Alignment> &) const noexcept
+        {
+            return true;
+        }
+
+        template <typename U>
+        bool operator!=(const AlignedAllocator<U, Alignment> &) const noexcept
+        {
+            return false;
+        }
+    };
+
+    template <typename T, std::size_t Alignment = 32>
+    using AlignedVector = std::vector<T, AlignedAllocator<T, Alignment>>;
+} // namespace pogl
@@ -0,0 +1,24 @@
+#include "cpu_features.hh"
+
+namespace pogl
+{
+    namespace
+    {
+        CpuFeatures detect_features()
+        {
+            CpuFeatures features{ false, false };
+#if defined(__x86_64__) || defined(__i386__)
+            __builtin_cpu_init();
+            features.sse42 = __builtin_cpu_supports("sse4.2");
+            features.avx2 = __builtin_cpu_supports("avx2");
+#endif
+            return features;
+        }
+    } // namespace
+
+    const CpuFeatures &cpu_features()
+    {
+        static const CpuFeatures features = detect_features();
+        return features;
+    }
+} // namespace pogl
@@ -0,0 +1,21 @@
+#pragma once
+
+namespace pogl
+{
+    /**
+     * @brief Instruction set extensions available on the running CPU, used
+     * to pick SIMD kernels at runtime.
+     */
+    struct CpuFeatures
+    {
+        bool sse42;
+        bool avx2;
+    };
+
+    /**
+     * @brief Detects the features of the running CPU once and caches them
+     *
+     * @return const CpuFeatures&
+     */
+    const CpuFeatures &cpu_features();
+} // namespace pogl
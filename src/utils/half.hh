@@ -0,0 +1,88 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+
+namespace pogl
+{
+    /**
+     * @brief Converts to an IEEE 754 half precision float, rounding to the
+     * nearest even like the hardware conversion. Values out of range become
+     * infinities.
+     *
+     * @param value
+     * @return std::uint16_t half float bits
+     */
+    inline std::uint16_t float_to_half(float value)
+    {
+        const auto bits = std::bit_cast<std::uint32_t>(value);
+        const std::uint32_t sign = (bits >> 16) & 0x8000;
+        const std::uint32_t magnitude = bits & 0x7fffffff;
+
+        if (magnitude >= 0x7f800000)
+        {
+            // infinity stays infinity, NaN stays quiet NaN
+            return sign | 0x7c00 | (magnitude > 0x7f800000 ? 0x200 : 0);
+        }
+        if (magnitude >= 0x477ff000)
+        {
+            // rounds past 65504, the largest half
+            return sign | 0x7c00;
+        }
+        if (magnitude < 0x38800000)
+        {
+            // below 2^-14: denormal half, or zero under 2^-25
+            if (magnitude < 0x33000000)
+            {
+                return sign;
+            }
+            const std::uint32_t exponent = magnitude >> 23;
+            const std::uint32_t mantissa = (magnitude & 0x7fffff) | 0x800000;
+            const std::uint32_t shift = 126 - exponent;
+            std::uint32_t half = mantissa >> shift;
+            const std::uint32_t remainder = mantissa & ((1u << shift) - 1);
+            const std::uint32_t halfway = 1u << (shift - 1);
+            if (remainder > halfway || (remainder == halfway && (half & 1)))
+            {
+                half++;
+            }
+            return sign | half;
+        }
+
+        // rebias the exponent from 127 to 15, a carry out of the mantissa
+        // correctly bumps the exponent
+        std::uint32_t half = (magnitude - 0x38000000) >> 13;
+        const std::uint32_t remainder = magnitude & 0x1fff;
+        if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1)))
+        {
+            half++;
+        }
+        return sign | half;
+    }
+
+    /**
+     * @brief Converts IEEE 754 half precision float bits to a float, exactly
+     *
+     * @param half half float bits
+     * @return float
+     */
+    inline float half_to_float(std::uint16_t half)
+    {
+        const std::uint32_t sign = (std::uint32_t)(half & 0x8000) << 16;
+        const std::uint32_t exponent = (half >> 10) & 0x1f;
+        const std::uint32_t mantissa = half & 0x3ff;
+
+        if (exponent == 0x1f)
+        {
+            return std::bit_cast<float>(sign | 0x7f800000 | (mantissa << 13));
+        }
+        if (exponent == 0)
+        {
+            // zero or denormal, mantissa * 2^-24 is exact in a float
+            const auto magnitude = (float)mantissa * 0x1p-24f;
+            return sign ? -magnitude : magnitude;
+        }
+        return std::bit_cast<float>(sign | ((exponent + 112) << 23)
+                                    | (mantissa << 13));
+    }
+} // namespace pogl
@@ -0,0 +1,71 @@
+#include "radix_sort.hh"
+
+#include <array>
+#include <cstddef>
+#include <utility>
+
+namespace pogl
+{
+    namespace
+    {
+        constexpr size_t PASS_COUNT = 4;
+        constexpr size_t BUCKET_COUNT = 256;
+        using HistogramType = std::array<std::uint32_t, BUCKET_COUNT>;
+
+        inline size_t digit(std::uint32_t key, size_t pass)
+        {
+            return (key >> (pass * 8)) & 0xff;
+        }
+    } // namespace
+
+    void RadixSorter::sort(BufferType &entries)
+    {
+        const auto count = entries.size();
+        if (count < 2)
+        {
+            return;
+        }
+
+        // every pass histogram is computed in a single read of the keys
+        std::array<HistogramType, PASS_COUNT> histograms{};
+        for (const auto &entry : entries)
+        {
+            for (size_t pass = 0; pass < PASS_COUNT; ++pass)
+            {
+                ++histograms[pass][digit(entry.key, pass)];
+            }
+        }
+
+        _scratch.resize(count);
+        auto *source = &entries;
+        auto *destination = &_scratch;
+        for (size_t pass = 0; pass < PASS_COUNT; ++pass)
+        {
+            auto &histogram = histograms[pass];
+            if (histogram[digit((*source)[0].key, pass)] == count)
+            {
+                continue;
+            }
+
+            // exclusive prefix sum turns counts into bucket offsets
+            std::uint32_t offset = 0;
+            for (auto &bucket : histogram)
+            {
+                const auto bucket_count = bucket;
+                bucket = offset;
+                offset += bucket_count;
+            }
+
+            for (const auto &entry : *source)
+            {
+                (*destination)[histogram[digit(entry.key, pass)]++] = entry;
+            }
+            std::swap(source, destination);
+        }
+
+        if (source != &entries)
+        {
+            entries.swap(_scratch);
+        }
+    }
+} // namespace pogl
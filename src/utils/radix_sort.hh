@@ -0,0 +1,69 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <vector>
+
+namespace pogl
+{
+    /**
+     * @brief Sort entry made of an ordering key and the index of the element
+     * it refers to, 8 bytes so that sorting moves as little data as possible.
+     */
+    struct KeyIndexPair
+    {
+        std::uint32_t key;
+        std::uint32_t index;
+    };
+
+    /**
+     * @brief Maps a float onto an unsigned integer with the same ordering:
+     * positive floats get their sign bit set, negative ones are inverted.
+     *
+     * @param value
+     * @return std::uint32_t
+     */
+    inline std::uint32_t float_sort_key(float value)
+    {
+        const auto bits = std::bit_cast<std::uint32_t>(value);
+        const std::uint32_t mask =
+            static_cast<std::uint32_t>(-static_cast<std::int32_t>(bits >> 31))
+            | 0x80000000u;
+        return bits ^ mask;
+    }
+
+    /**
+     * @brief Key of a squared distance such that increasing keys go from the
+     * farthest element to the nearest, the order alpha blending draws in.
+     *
+     * @param squared_distance
+     * @return std::uint32_t
+     */
+    inline std::uint32_t far_to_near_key(float squared_distance)
+    {
+        return ~float_sort_key(squared_distance);
+    }
+
+    /**
+     * @brief Stable least significant digit radix sort of 32-bit keys, one
+     * byte per pass. Keeps its scratch buffer between calls so that sorting
+     * every frame does not allocate.
+     */
+    class RadixSorter
+    {
+    public:
+        using EntryType = KeyIndexPair;
+        using BufferType = std::vector<EntryType>;
+
+        /**
+         * @brief Sorts entries by increasing key. Passes on a byte shared by
+         * every key are skipped.
+         *
+         * @param entries
+         */
+        void sort(BufferType &entries);
+
+    private:
+        BufferType _scratch;
+    };
+} // namespace pogl
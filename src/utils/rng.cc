@@ -0,0 +1,208 @@
+#include "rng.hh"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "cpu_features.hh"
+#include "log.hh"
+
+namespace pogl
+{
+    namespace
+    {
+        constexpr float UNIT_FLOAT = 0x1p-24f;
+
+        inline std::uint64_t rotl(std::uint64_t x, int k)
+        {
+            return (x << k) | (x >> (64 - k));
+        }
+
+        inline std::uint32_t rotl(std::uint32_t x, int k)
+        {
+            return (x << k) | (x >> (32 - k));
+        }
+
+        /**
+         * @brief splitmix64 state of a stream, mixing the seed first so that
+         * nearby seeds and nearby streams do not give related states.
+         */
+        std::uint64_t stream_state(std::uint64_t seed, std::uint64_t stream)
+        {
+            auto state = seed;
+            return splitmix64(state) ^ stream;
+        }
+
+        using FillKernelType = void (*)(std::uint32_t *, float *, size_t,
+                                        float, float);
+
+        FillKernelType select_fill_kernel()
+        {
+            static const FillKernelType kernel = []() {
+#if defined(__x86_64__) || defined(__i386__)
+                if (cpu_features().avx2)
+                {
+                    return kernels::fill_avx2;
+                }
+#endif
+                return kernels::fill_scalar;
+            }();
+            return kernel;
+        }
+
+        std::atomic<std::uint64_t> global_seed_value(0);
+        std::atomic<std::uint64_t> next_thread_stream(0);
+    } // namespace
+
+    Xoshiro256::Xoshiro256(std::uint64_t seed, std::uint64_t stream)
+        : _state()
+    {
+        auto state = stream_state(seed, stream);
+        for (auto &word : _state)
+        {
+            word = splitmix64(state);
+        }
+    }
+
+    Xoshiro256::result_type Xoshiro256::operator()()
+    {
+        const auto result = rotl(_state[0] + _state[3], 23) + _state[0];
+        const auto t = _state[1] << 17;
+
+        _state[2] ^= _state[0];
+        _state[3] ^= _state[1];
+        _state[1] ^= _state[2];
+        _state[0] ^= _state[3];
+        _state[2] ^= t;
+        _state[3] = rotl(_state[3], 45);
+
+        return result;
+    }
+
+    float Xoshiro256::range(float low, float high)
+    {
+        const auto unit = static_cast<float>((*this)() >> 40) * UNIT_FLOAT;
+        return low + unit * (high - low);
+    }
+
+    RandomBatch::RandomBatch(std::uint64_t seed, std::uint64_t stream)
+        : _state()
+    {
+        auto state = stream_state(seed, stream);
+        for (size_t i = 0; i < _state.size(); i += 2)
+        {
+            const auto bits = splitmix64(state);
+            _state[i] = static_cast<std::uint32_t>(bits);
+            _state[i + 1] = static_cast<std::uint32_t>(bits >> 32);
+        }
+    }
+
+    void RandomBatch::fill(float *out, size_t count, float low, float high)
+    {
+        const auto scale = high - low;
+        const auto groups = count / LANES;
+        select_fill_kernel()(_state.data(), out, groups, low, scale);
+
+        const auto remaining = count - groups * LANES;
+        if (remaining > 0)
+        {
+            float tail[LANES];
+            select_fill_kernel()(_state.data(), tail, 1, low, scale);
+            for (size_t i = 0; i < remaining; ++i)
+            {
+                out[groups * LANES + i] = tail[i];
+            }
+        }
+    }
+
+    std::uint64_t environment_seed()
+    {
+        const auto *value = std::getenv("POGL_SEED");
+        if (value != nullptr)
+        {
+            try
+            {
+                return std::stoull(value, nullptr, 0);
+            }
+            catch (const std::exception &)
+            {
+                std::cerr << LOG_WARNING << "ignoring invalid POGL_SEED `"
+                          << value << "`\n";
+            }
+        }
+        return std::chrono::high_resolution_clock::now()
+            .time_since_epoch()
+            .count();
+    }
+
+    double environment_fixed_step()
+    {
+        const auto *value = std::getenv("POGL_FIXED_STEP");
+        if (value == nullptr)
+            return 0;
+        try
+        {
+            const auto step = std::stod(value);
+            if (step > 0)
+                return step;
+        }
+        catch (const std::exception &)
+        {}
+        std::cerr << LOG_WARNING << "ignoring invalid POGL_FIXED_STEP `"
+                  << value << "`\n";
+        return 0;
+    }
+
+    void set_global_seed(std::uint64_t seed)
+    {
+        global_seed_value.store(seed, std::memory_order_relaxed);
+    }
+
+    std::uint64_t global_seed()
+    {
+        return global_seed_value.load(std::memory_order_relaxed);
+    }
+
+    Xoshiro256 &thread_rng()
+    {
+        // streams start at 1, stream 0 is left to direct users of the seed
+        thread_local Xoshiro256 generator(
+            global_seed(),
+            next_thread_stream.fetch_add(1, std::memory_order_relaxed) + 1);
+        return generator;
+    }
+
+    namespace kernels
+    {
+        void fill_scalar(std::uint32_t *state, float *out, size_t groups,
+                         float low, float scale)
+        {
+            constexpr auto LANES = RandomBatch::LANES;
+            auto *s0 = state;
+            auto *s1 = state + LANES;
+            auto *s2 = state + 2 * LANES;
+            auto *s3 = state + 3 * LANES;
+            for (size_t group = 0; group < groups; ++group)
+            {
+                for (size_t lane = 0; lane < LANES; ++lane)
+                {
+                    const auto result = rotl(s0[lane] + s3[lane], 7) + s0[lane];
+                    const auto t = s1[lane] << 9;
+
+                    s2[lane] ^= s0[lane];
+                    s3[lane] ^= s1[lane];
+                    s1[lane] ^= s2[lane];
+                    s0[lane] ^= s3[lane];
+                    s2[lane] ^= t;
+                    s3[lane] = rotl(s3[lane], 11);
+
+                    const auto unit =
+                        static_cast<float>(result >> 8) * UNIT_FLOAT;
+                    out[group * LANES + lane] = low + unit * scale;
+                }
+            }
+        }
+    } // namespace kernels
+} // namespace pogl
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace pogl
+{
+    /**
+     * @brief Advances a splitmix64 state and returns its next output, used to
+     * expand 64-bit seeds into generator states.
+     *
+     * @param state
+     * @return std::uint64_t
+     */
+    inline std::uint64_t splitmix64(std::uint64_t &state)
+    {
+        auto z = (state += 0x9e3779b97f4a7c15);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+        return z ^ (z >> 31);
+    }
+
+    /**
+     * @brief xoshiro256++ generator, usable with the standard distributions.
+     * Generators built from the same seed but different streams give
+     * independent sequences.
+     */
+    class Xoshiro256
+    {
+    public:
+        using result_type = std::uint64_t;
+
+        explicit Xoshiro256(std::uint64_t seed, std::uint64_t stream = 0);
+
+        static constexpr result_type min()
+        {
+            return 0;
+        }
+
+        static constexpr result_type max()
+        {
+            return UINT64_MAX;
+        }
+
+        result_type operator()();
+
+        /**
+         * @brief Uniform float in [low; high)
+         *
+         * @param low
+         * @param high
+         * @return float
+         */
+        float range(float low, float high);
+
+    private:
+        std::array<std::uint64_t, 4> _state;
+    };
+
+    /**
+     * @brief Eight xoshiro128++ generators advanced together to fill arrays
+     * of uniform floats, with AVX2 when available. Every implementation
+     * produces the same values.
+     */
+    class RandomBatch
+    {
+    public:
+        static constexpr size_t LANES = 8;
+
+        explicit RandomBatch(std::uint64_t seed, std::uint64_t stream = 0);
+
+        /**
+         * @brief Writes count uniform floats in [low; high) to out. Values are
+         * drawn LANES at a time, a partial group discards its extra values.
+         *
+         * @param out
+         * @param count
+         * @param low
+         * @param high
+         */
+        void fill(float *out, size_t count, float low, float high);
+
+    private:
+        // word w of lane l is at w * LANES + l
+        alignas(32) std::array<std::uint32_t, 4 * LANES> _state;
+    };
+
+    /**
+     * @brief Seed from the POGL_SEED environment variable, or from the clock
+     * when it is not set.
+     *
+     * @return std::uint64_t
+     */
+    std::uint64_t environment_seed();
+
+    /**
+     * @brief Frame time in seconds from the POGL_FIXED_STEP environment
+     * variable, or 0 when it is not set. Runs with the same seed and a fixed
+     * step simulate the same frames.
+     *
+     * @return double
+     */
+    double environment_fixed_step();
+
+    /**
+     * @brief Sets the seed every simulation generator derives from. Must be
+     * called before the engine is initialised for runs to be reproducible.
+     *
+     * @param seed
+     */
+    void set_global_seed(std::uint64_t seed);
+    std::uint64_t global_seed();
+
+    /**
+     * @brief Generator of the calling thread, seeded from the global seed and
+     * the order in which threads first use it.
+     *
+     * @return Xoshiro256&
+     */
+    Xoshiro256 &thread_rng();
+
+    namespace kernels
+    {
+        // one step of every lane per group of LANES values
+        void fill_scalar(std::uint32_t *state, float *out, size_t groups,
+                         float low, float scale);
+        void fill_avx2(std::uint32_t *state, float *out, size_t groups,
+                       float low, float scale);
+    } // namespace kernels
+} // namespace pogl
@@ -0,0 +1,62 @@
+#include "rng.hh"
+
+#if defined(__x86_64__) || defined(__i386__)
+#    include <immintrin.h>
+
+namespace pogl::kernels
+{
+    // Same steps as fill_scalar on eight lanes at once. The integer to float
+    // conversion of 24-bit values is exact and the multiply and add are kept
+    // separate, so the values match the scalar kernel bit for bit.
+
+    namespace
+    {
+        __attribute__((target("avx2"))) inline __m256i rotl_avx2(__m256i x,
+                                                                 int k)
+        {
+            return _mm256_or_si256(_mm256_slli_epi32(x, k),
+                                   _mm256_srli_epi32(x, 32 - k));
+        }
+    } // namespace
+
+    __attribute__((target("avx2"))) void fill_avx2(std::uint32_t *state,
+                                                   float *out, size_t groups,
+                                                   float low, float scale)
+    {
+        constexpr auto LANES = RandomBatch::LANES;
+        auto *words = reinterpret_cast<__m256i *>(state);
+        auto s0 = _mm256_loadu_si256(words);
+        auto s1 = _mm256_loadu_si256(words + 1);
+        auto s2 = _mm256_loadu_si256(words + 2);
+        auto s3 = _mm256_loadu_si256(words + 3);
+        const auto unit_v = _mm256_set1_ps(0x1p-24f);
+        const auto low_v = _mm256_set1_ps(low);
+        const auto scale_v = _mm256_set1_ps(scale);
+
+        for (size_t group = 0; group < groups; ++group)
+        {
+            const auto result = _mm256_add_epi32(
+                rotl_avx2(_mm256_add_epi32(s0, s3), 7), s0);
+            const auto t = _mm256_slli_epi32(s1, 9);
+
+            s2 = _mm256_xor_si256(s2, s0);
+            s3 = _mm256_xor_si256(s3, s1);
+            s1 = _mm256_xor_si256(s1, s2);
+            s0 = _mm256_xor_si256(s0, s3);
+            s2 = _mm256_xor_si256(s2, t);
+            s3 = rotl_avx2(s3, 11);
+
+            const auto unit = _mm256_mul_ps(
+                _mm256_cvtepi32_ps(_mm256_srli_epi32(result, 8)), unit_v);
+            _mm256_storeu_ps(out + group * LANES,
+                             _mm256_add_ps(low_v, _mm256_mul_ps(unit, scale_v)));
+        }
+
+        _mm256_storeu_si256(words, s0);
+        _mm256_storeu_si256(words + 1, s1);
+        _mm256_storeu_si256(words + 2, s2);
+        _mm256_storeu_si256(words + 3, s3);
+    }
+} // namespace pogl::kernels
+
+#endif // x86
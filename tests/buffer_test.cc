@@ -0,0 +1,153 @@
+#include <GL/glew.h>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer.hh"
+#include "headless_context.hh"
+#include "utils/gl_check.hh"
+#include "utils/log.hh"
+
+using namespace pogl;
+
+namespace
+{
+    constexpr size_t ELEMENT_COUNT = 64;
+    constexpr size_t PARTIAL_FIRST = 10;
+    constexpr size_t PARTIAL_COUNT = 8;
+
+    struct PolicyCase
+    {
+        const char *name;
+        Buffer::UpdatePolicy policy;
+        size_t orphanings;
+    };
+
+    // whole updates orphan the storage only with the ORPHAN policy
+    const PolicyCase POLICIES[] = {
+        { "SUB_DATA", Buffer::UpdatePolicy::SUB_DATA, 0 },
+        { "ORPHAN", Buffer::UpdatePolicy::ORPHAN, 1 },
+        { "MAP_INVALIDATE", Buffer::UpdatePolicy::MAP_INVALIDATE, 0 },
+    };
+
+    std::vector<float> read_buffer(const Buffer &buffer)
+    {
+        std::vector<float> data(buffer.count<float>());
+        glGetNamedBufferSubData(buffer.id(), 0, buffer.size(), data.data());
+        CHECK_GL_ERROR();
+        return data;
+    }
+
+    GLuint bound_buffer()
+    {
+        GLint binding = 0;
+        glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &binding);
+        CHECK_GL_ERROR();
+        return binding;
+    }
+
+    int expect(bool condition, const PolicyCase &test,
+               const std::string &what)
+    {
+        if (condition)
+            return 0;
+        std::cerr << LOG_ERROR << test.name << ": " << what << std::endl;
+        return 1;
+    }
+
+    int check_policy(const PolicyCase &test)
+    {
+        Buffer buffer(GL_ARRAY_BUFFER, GL_DYNAMIC_DRAW, test.policy);
+        std::vector<float> expected(ELEMENT_COUNT);
+        std::iota(expected.begin(), expected.end(), 0.f);
+        buffer.set_data(std::span<const float>(expected));
+
+        int failures = 0;
+        failures += expect(buffer.size() == ELEMENT_COUNT * sizeof(float)
+                               && buffer.count<float>() == ELEMENT_COUNT
+                               && buffer.count<double>() == ELEMENT_COUNT / 2,
+                           test, "wrong storage size");
+        failures += expect(read_buffer(buffer) == expected, test,
+                           "set_data did not upload the data");
+
+        std::iota(expected.begin(), expected.end(), 100.f);
+        buffer.update(std::span<const float>(expected));
+        failures += expect(read_buffer(buffer) == expected, test,
+                           "whole update did not write the data");
+
+        std::vector<float> partial(PARTIAL_COUNT);
+        std::iota(partial.begin(), partial.end(), -50.f);
+        buffer.update(std::span<const float>(partial), PARTIAL_FIRST);
+        std::copy(partial.begin(), partial.end(),
+                  expected.begin() + PARTIAL_FIRST);
+        failures += expect(read_buffer(buffer) == expected, test,
+                           "partial update did not write its range only");
+
+        buffer.update(std::span<const float>());
+        bool threw = false;
+        try
+        {
+            buffer.update(std::span<const float>(partial),
+                          ELEMENT_COUNT - PARTIAL_COUNT / 2);
+        }
+        catch (const std::out_of_range &)
+        {
+            threw = true;
+        }
+        failures += expect(threw, test, "overflowing update did not throw");
+        failures += expect(read_buffer(buffer) == expected, test,
+                           "rejected updates changed the data");
+
+        const auto &usage = buffer.usage();
+        const auto bytes = (ELEMENT_COUNT * 2 + PARTIAL_COUNT) * sizeof(float);
+        failures += expect(usage.allocations == 1 && usage.updates == 2
+                               && usage.orphanings == test.orphanings
+                               && usage.bytes_uploaded == bytes,
+                           test,
+                           "usage counts " + std::to_string(usage.allocations)
+                               + " allocations, "
+                               + std::to_string(usage.updates) + " updates, "
+                               + std::to_string(usage.orphanings)
+                               + " orphanings, "
+                               + std::to_string(usage.bytes_uploaded)
+                               + " bytes");
+
+        buffer.bind();
+        failures += expect(bound_buffer() == buffer.id(), test,
+                           "bind did not bind the buffer");
+        buffer.unbind();
+        failures += expect(bound_buffer() == 0, test,
+                           "unbind left the buffer bound");
+        return failures;
+    }
+
+    int run()
+    {
+        HeadlessContext context;
+        if (!context.is_ready())
+            return TEST_SKIPPED;
+
+        int failures = 0;
+        for (const auto &test : POLICIES)
+            failures += check_policy(test);
+        std::cout << LOG_INFO << failures << " failures" << std::endl;
+        return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+} // namespace
+
+int main()
+{
+    try
+    {
+        return run();
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << LOG_ERROR << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
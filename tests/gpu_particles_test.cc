@@ -0,0 +1,155 @@
+#include <GL/glew.h>
+#include <cmath>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <vector>
+
+#include "headless_context.hh"
+#include "particle_system/gpu_particle_system.hh"
+#include "utils/gl_check.hh"
+#include "utils/log.hh"
+#include "utils/rng.hh"
+
+using namespace pogl;
+
+namespace
+{
+    constexpr size_t PARTICLE_COUNT = 1000;
+    constexpr size_t TEXTURE_COUNT = 4;
+    constexpr size_t STEP_COUNT = 240;
+    constexpr float DELTA = 1.f / 60;
+    // integration runs in float on both sides, in a different order
+    constexpr float TOLERANCE = 1e-4;
+    constexpr std::uint64_t SEED = 0x5eed;
+
+    // std430 layout of the shaders' Particle struct
+    struct Particle
+    {
+        float position[4]; // xyz, rotation in degrees
+        float velocity[4]; // xyz, angular velocity in degrees per second
+        float appearance[4]; // scale, texture id, unused, unused
+    };
+    static_assert(sizeof(Particle) == GpuParticleSystem::PARTICLE_SIZE);
+
+    std::vector<Particle> read_particles(const GpuParticleSystem &system)
+    {
+        std::vector<Particle> particles(PARTICLE_COUNT);
+        glGetNamedBufferSubData(system.particle_buffer(), 0,
+                                particles.size() * sizeof(Particle),
+                                particles.data());
+        CHECK_GL_ERROR();
+        return particles;
+    }
+
+    bool is_spawned(const Particle &particle)
+    {
+        const auto center = GpuParticleSystem::SPAWN_CENTER;
+        const auto &position = particle.position;
+        return std::abs(position[0] - center.x) <= 3
+            && std::abs(position[1] - center.y) <= 3
+            && particle.velocity[2] >= -2 && particle.velocity[2] <= -1
+            && particle.appearance[0] == 1 && particle.appearance[1] >= 0
+            && particle.appearance[1] < TEXTURE_COUNT;
+    }
+
+    bool is_integrated(const Particle &before, const Particle &after)
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            const auto expected =
+                before.position[i] + before.velocity[i] * DELTA;
+            if (!(std::abs(after.position[i] - expected) <= TOLERANCE))
+                return false;
+        }
+        return true;
+    }
+
+    int run()
+    {
+        HeadlessContext context;
+        if (!context.is_ready())
+            return TEST_SKIPPED;
+
+        set_global_seed(SEED);
+        auto simulation = ShaderProgram::make_compute_program(
+            resource_path("shaders/particle_system/simulation.glsl"));
+        auto shader = ShaderProgram::make_program(
+            resource_path("shaders/particle_system/vertex_gpu.glsl"),
+            resource_path("shaders/particle_system/fragment.glsl"));
+        GpuParticleSystem system(simulation, shader, PARTICLE_COUNT,
+                                 TEXTURE_COUNT);
+
+        int failures = 0;
+        auto particles = read_particles(system);
+        for (size_t i = 0; i < PARTICLE_COUNT; i++)
+        {
+            const auto z = particles[i].position[2];
+            if (!is_spawned(particles[i])
+                || !(z >= GpuParticleSystem::RESPAWN_HEIGHT
+                     && z <= GpuParticleSystem::INITIAL_HEIGHT))
+            {
+                std::cerr << LOG_ERROR << "particle " << i
+                          << " was not spawned in the column" << std::endl;
+                failures++;
+            }
+        }
+
+        // every step either moves a particle by its velocity or respawns
+        // it at the top once it fell below the respawn height
+        size_t respawns = 0;
+        for (size_t step = 0; step < STEP_COUNT && failures == 0; step++)
+        {
+            system.update(DELTA);
+            auto next = read_particles(system);
+            for (size_t i = 0; i < PARTICLE_COUNT; i++)
+            {
+                const auto &before = particles[i];
+                const auto &after = next[i];
+                bool valid;
+                if (before.position[2] < GpuParticleSystem::RESPAWN_HEIGHT)
+                {
+                    valid = is_spawned(after)
+                        && after.position[2]
+                            == GpuParticleSystem::SPAWN_CENTER.z;
+                    respawns++;
+                }
+                else
+                {
+                    valid = is_integrated(before, after);
+                }
+                if (!valid)
+                {
+                    std::cerr << LOG_ERROR << "particle " << i
+                              << " went wrong at step " << step << std::endl;
+                    failures++;
+                }
+            }
+            particles = std::move(next);
+        }
+
+        // the column is 7 units high and flakes fall at 1 to 2 units per
+        // second, so some must have landed in 4 seconds
+        if (failures == 0 && respawns == 0)
+        {
+            std::cerr << LOG_ERROR << "no particle respawned" << std::endl;
+            failures++;
+        }
+        std::cout << LOG_INFO << STEP_COUNT << " steps, " << respawns
+                  << " respawns, " << failures << " failures" << std::endl;
+        return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+} // namespace
+
+int main()
+{
+    try
+    {
+        return run();
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << LOG_ERROR << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,148 @@
+#include <GL/glew.h>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <vector>
+
+#include "headless_context.hh"
+#include "particle_system/gpu_particle_system.hh"
+#include "utils/gl_check.hh"
+#include "utils/log.hh"
+#include "utils/radix_sort.hh"
+#include "utils/rng.hh"
+
+using namespace pogl;
+
+namespace
+{
+    constexpr size_t TEXTURE_COUNT = 4;
+    constexpr size_t STEP_COUNT = 30;
+    constexpr float DELTA = 1.f / 60;
+    constexpr std::uint64_t SEED = 0x5eed;
+    // below one sort block, a few blocks, and many blocks with padding
+    constexpr size_t PARTICLE_COUNTS[] = {100, 1000, 5000};
+    const Vector3 ORIGINS[] = {
+        Vector3(0, 0, 0),
+        Vector3(1.5, -2, 3),
+        GpuParticleSystem::SPAWN_CENTER,
+    };
+
+    // std430 layout of the shaders' Particle struct
+    struct Particle
+    {
+        float position[4];
+        float velocity[4];
+        float appearance[4];
+    };
+    static_assert(sizeof(Particle) == GpuParticleSystem::PARTICLE_SIZE);
+
+    template <typename T>
+    std::vector<T> read_buffer(GLuint buffer, size_t count)
+    {
+        std::vector<T> data(count);
+        glGetNamedBufferSubData(buffer, 0, count * sizeof(T), data.data());
+        CHECK_GL_ERROR();
+        return data;
+    }
+
+    /**
+     * @brief Order of ParticleRenderer::sort_particles: far to near keys
+     * of the squared distances, sorted by the radix sorter
+     */
+    RadixSorter::BufferType cpu_order(const std::vector<Particle> &particles,
+                                      const Vector3 &origin)
+    {
+        RadixSorter::BufferType entries(particles.size());
+        for (size_t i = 0; i < particles.size(); i++)
+        {
+            const auto &position = particles[i].position;
+            const auto dx = position[0] - origin.x;
+            const auto dy = position[1] - origin.y;
+            const auto dz = position[2] - origin.z;
+            entries[i] = KeyIndexPair{
+                far_to_near_key(dx * dx + dy * dy + dz * dz),
+                static_cast<std::uint32_t>(i)};
+        }
+        RadixSorter sorter;
+        sorter.sort(entries);
+        return entries;
+    }
+
+    int compare_orders(size_t particle_count)
+    {
+        set_global_seed(SEED);
+        auto simulation = ShaderProgram::make_compute_program(
+            resource_path("shaders/particle_system/simulation.glsl"));
+        auto shader = ShaderProgram::make_program(
+            resource_path("shaders/particle_system/vertex_gpu.glsl"),
+            resource_path("shaders/particle_system/fragment.glsl"));
+        GpuParticleSystem system(simulation, shader, particle_count,
+                                 TEXTURE_COUNT);
+        system.set_sort_programs(
+            ShaderProgram::make_compute_program(
+                resource_path("shaders/particle_system/depth_keys.glsl")),
+            ShaderProgram::make_compute_program(
+                resource_path("shaders/particle_system/bitonic_sort.glsl")));
+        if (system.order_buffer() == 0)
+        {
+            std::cerr << LOG_ERROR << "the GPU sort is unavailable"
+                      << std::endl;
+            return 1;
+        }
+        // some particles respawn so the set is not the initial one
+        for (size_t step = 0; step < STEP_COUNT; step++)
+            system.update(DELTA);
+
+        const auto particles =
+            read_buffer<Particle>(system.particle_buffer(), particle_count);
+        int failures = 0;
+        for (const auto &origin : ORIGINS)
+        {
+            system.sort(origin);
+            const auto gpu = read_buffer<KeyIndexPair>(system.order_buffer(),
+                                                       particle_count);
+            const auto cpu = cpu_order(particles, origin);
+            for (size_t i = 0; i < particle_count; i++)
+            {
+                if (gpu[i].index != cpu[i].index || gpu[i].key != cpu[i].key)
+                {
+                    std::cerr << LOG_ERROR << particle_count
+                              << " particles from " << origin
+                              << ": orders differ at " << i << ", GPU ("
+                              << gpu[i].key << ", " << gpu[i].index
+                              << ") CPU (" << cpu[i].key << ", "
+                              << cpu[i].index << ")" << std::endl;
+                    failures++;
+                    break;
+                }
+            }
+        }
+        return failures;
+    }
+
+    int run()
+    {
+        HeadlessContext context;
+        if (!context.is_ready())
+            return TEST_SKIPPED;
+
+        int failures = 0;
+        for (auto count : PARTICLE_COUNTS)
+            failures += compare_orders(count);
+        std::cout << LOG_INFO << failures << " failures" << std::endl;
+        return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+} // namespace
+
+int main()
+{
+    try
+    {
+        return run();
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << LOG_ERROR << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,122 @@
+#include "headless_context.hh"
+
+#include <EGL/eglext.h>
+#include <GL/glew.h>
+#include <iostream>
+
+#include "utils/log.hh"
+
+namespace pogl
+{
+    namespace
+    {
+        EGLDisplay open_display()
+        {
+            const auto get_platform_display =
+                reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+                    eglGetProcAddress("eglGetPlatformDisplayEXT"));
+            if (get_platform_display != nullptr)
+            {
+                auto display = get_platform_display(
+                    EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY,
+                    nullptr);
+                if (display != EGL_NO_DISPLAY)
+                    return display;
+            }
+            return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+        }
+
+        bool init_glew()
+        {
+            glewExperimental = GL_TRUE;
+            const auto status = glewInit();
+            // GLEW built for GLX finds no GLX display, the GL entry points
+            // are loaded all the same
+#ifdef GLEW_ERROR_NO_GLX_DISPLAY
+            if (status == GLEW_ERROR_NO_GLX_DISPLAY)
+                return true;
+#endif // GLEW_ERROR_NO_GLX_DISPLAY
+            return status == GLEW_OK;
+        }
+    } // namespace
+
+    HeadlessContext::HeadlessContext()
+        : _display(EGL_NO_DISPLAY)
+        , _context(EGL_NO_CONTEXT)
+        , _ready(false)
+    {
+        _display = open_display();
+        if (_display == EGL_NO_DISPLAY
+            || !eglInitialize(_display, nullptr, nullptr))
+        {
+            std::cerr << LOG_WARNING << "no EGL display" << std::endl;
+            _display = EGL_NO_DISPLAY;
+            return;
+        }
+        if (!eglBindAPI(EGL_OPENGL_API))
+        {
+            std::cerr << LOG_WARNING << "EGL cannot create OpenGL contexts"
+                      << std::endl;
+            return;
+        }
+
+        const EGLint attributes[] = {
+            EGL_CONTEXT_MAJOR_VERSION,
+            4,
+            EGL_CONTEXT_MINOR_VERSION,
+            5,
+            EGL_CONTEXT_OPENGL_PROFILE_MASK,
+            EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+            EGL_NONE,
+        };
+        // no config, the context never draws to a surface
+        _context = eglCreateContext(_display, EGL_NO_CONFIG_KHR,
+                                    EGL_NO_CONTEXT, attributes);
+        if (_context == EGL_NO_CONTEXT)
+        {
+            std::cerr << LOG_WARNING << "could not create an OpenGL 4.5 core "
+                      << "context (EGL error 0x" << std::hex << eglGetError()
+                      << std::dec << ")" << std::endl;
+            return;
+        }
+        if (!eglMakeCurrent(_display, EGL_NO_SURFACE, EGL_NO_SURFACE,
+                            _context))
+        {
+            std::cerr << LOG_WARNING << "could not make the context current"
+                      << std::endl;
+            return;
+        }
+        if (!init_glew())
+        {
+            std::cerr << LOG_WARNING << "could not load GLEW" << std::endl;
+            return;
+        }
+        // glewExperimental may leave an error behind
+        glGetError();
+
+        std::cout << LOG_INFO << "running on " << glGetString(GL_RENDERER)
+                  << std::endl;
+        _ready = true;
+    }
+
+    HeadlessContext::~HeadlessContext()
+    {
+        if (_display == EGL_NO_DISPLAY)
+            return;
+        eglMakeCurrent(_display, EGL_NO_SURFACE, EGL_NO_SURFACE,
+                       EGL_NO_CONTEXT);
+        if (_context != EGL_NO_CONTEXT)
+            eglDestroyContext(_display, _context);
+        eglTerminate(_display);
+    }
+
+    bool HeadlessContext::is_ready() const
+    {
+        return _ready;
+    }
+
+    std::string resource_path(const std::string &path)
+    {
+        return std::string(POGL_RESOURCE_DIR) + "/" + path;
+    }
+} // namespace pogl
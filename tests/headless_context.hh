@@ -0,0 +1,49 @@
+#pragma once
+
+#include <EGL/egl.h>
+#include <string>
+
+namespace pogl
+{
+    /**
+     * @brief Exit code telling CTest that a test was skipped
+     */
+    constexpr int TEST_SKIPPED = 77;
+
+    /**
+     * @brief OpenGL 4.5 core context without any window or surface, made
+     * current on construction. Prefers Mesa's surfaceless platform so that
+     * no display server is needed.
+     */
+    class HeadlessContext
+    {
+    public:
+        HeadlessContext();
+        ~HeadlessContext();
+
+        HeadlessContext(const HeadlessContext &) = delete;
+        HeadlessContext &operator=(const HeadlessContext &) = delete;
+
+        /**
+         * @brief Whether the context is current and GLEW is loaded, the
+         * reason of a failure is logged
+         *
+         * @return true
+         * @return false
+         */
+        bool is_ready() const;
+
+    private:
+        EGLDisplay _display;
+        EGLContext _context;
+        bool _ready;
+    };
+
+    /**
+     * @brief Path of a file in the resources directory
+     *
+     * @param path relative to the resources directory
+     * @return std::string
+     */
+    std::string resource_path(const std::string &path);
+} // namespace pogl
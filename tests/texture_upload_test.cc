@@ -0,0 +1,146 @@
+#include <GL/glew.h>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <vector>
+
+#include "headless_context.hh"
+#include "image/height_map.hh"
+#include "texture/texture.hh"
+#include "utils/gl_check.hh"
+#include "utils/log.hh"
+
+using namespace pogl;
+
+namespace
+{
+    // not a multiple of the tile size, so that edge tiles are clipped
+    constexpr HeightMap::DimensionType WIDTH = 1000;
+    constexpr HeightMap::DimensionType HEIGHT = 600;
+    // enough frames to go around the ring of upload regions
+    constexpr size_t FRAME_COUNT = 8;
+
+    struct PrecisionCase
+    {
+        const char *name;
+        HeightMap::Precision precision;
+    };
+
+    const PrecisionCase PRECISIONS[] = {
+        { "UNORM8", HeightMap::Precision::UNORM8 },
+        { "UNORM16", HeightMap::Precision::UNORM16 },
+        { "FLOAT32", HeightMap::Precision::FLOAT32 },
+    };
+
+    float texel_value(size_t index, size_t frame)
+    {
+        return ((index * 7919 + frame * 31) % 1000) / 1000.f;
+    }
+
+    void write_region(HeightMap &map, const HeightMap::Region &region,
+                      size_t frame)
+    {
+        for (int y = region.y; y < region.y + region.height; y++)
+        {
+            for (int x = region.x; x < region.x + region.width; x++)
+            {
+                const auto index = (size_t)y * map.width() + x;
+                map.set(index, texel_value(index, frame));
+            }
+        }
+        map.mark_dirty(region);
+    }
+
+    /**
+     * @brief Number of texels of the texture that differ from map
+     */
+    size_t count_mismatches(Texture &texture, const HeightMap &map)
+    {
+        const auto texel_size = map.texel_size();
+        std::vector<std::byte> texels((size_t)map.width() * map.height()
+                                      * texel_size);
+        texture.use();
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        CHECK_GL_ERROR();
+        glGetTexImage(GL_TEXTURE_2D, 0, GL_RED, map.pixel_type(),
+                      texels.data());
+        CHECK_GL_ERROR();
+        size_t mismatches = 0;
+        for (size_t i = 0; i < texels.size(); i += texel_size)
+        {
+            if (std::memcmp(texels.data() + i, map.data() + i, texel_size))
+                mismatches++;
+        }
+        return mismatches;
+    }
+
+    int check_precision(const PrecisionCase &test)
+    {
+        HeightMap map(WIDTH, HEIGHT, test.precision);
+        auto texture = Texture::builder()
+                           .buffer(FloatImageBuffer::sized(1, 1, 1))
+                           .src_format(GL_RED)
+                           .format(map.internal_format())
+                           .build();
+        texture->set_image(map);
+
+        int failures = 0;
+        // a few tiles per frame go through the ring of unpack buffers
+        for (size_t frame = 0; frame < FRAME_COUNT; frame++)
+        {
+            const auto offset = (int)frame * 13;
+            write_region(map, { offset, offset / 2, 5, 70 }, frame);
+            write_region(map, { WIDTH - 1, HEIGHT - 1, 1, 1 }, frame);
+            write_region(map, { 150, 100 + offset, 100, 3 }, frame);
+            const auto regions = map.take_dirty_regions();
+            texture->update_regions(map, regions);
+            const auto mismatches = count_mismatches(*texture, map);
+            if (mismatches != 0)
+            {
+                std::cerr << LOG_ERROR << test.name << ": " << mismatches
+                          << " texels differ after tiled frame " << frame
+                          << std::endl;
+                failures++;
+            }
+        }
+
+        // past the full upload share, the whole map is copied at once
+        write_region(map, { 0, 0, WIDTH, HEIGHT }, FRAME_COUNT);
+        texture->update_regions(map, map.take_dirty_regions());
+        const auto mismatches = count_mismatches(*texture, map);
+        if (mismatches != 0)
+        {
+            std::cerr << LOG_ERROR << test.name << ": " << mismatches
+                      << " texels differ after the full upload" << std::endl;
+            failures++;
+        }
+        return failures;
+    }
+
+    int run()
+    {
+        HeadlessContext context;
+        if (!context.is_ready())
+            return TEST_SKIPPED;
+
+        int failures = 0;
+        for (const auto &test : PRECISIONS)
+            failures += check_precision(test);
+        std::cout << LOG_INFO << failures << " failures" << std::endl;
+        return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+} // namespace
+
+int main()
+{
+    try
+    {
+        return run();
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << LOG_ERROR << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}